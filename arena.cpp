@@ -0,0 +1,179 @@
+#include "arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace
+{
+
+constexpr std::size_t MIN_CHUNK = std::size_t(1) << 20;
+
+} // namespace
+
+thread_local Arena* Arena::t_current = nullptr;
+thread_local unsigned Arena::t_depth = 0;
+
+Arena::~Arena()
+{
+    freeChunks();
+}
+
+unsigned Arena::sizeClass(std::size_t bytes)
+{
+    unsigned n = 0;
+
+    while ((std::size_t(1) << n) < bytes)
+        ++n;
+
+    return n;
+}
+
+void* Arena::allocate(std::size_t bytes, std::size_t align)
+{
+    if (bytes >= MIN_RECYCLED)
+    {
+        if (void* p = recycle(bytes, align))
+            return p;
+    }
+
+    if (!m_chunks.empty())
+    {
+        auto const& chunk = m_chunks.back();
+        auto const base = reinterpret_cast<std::uintptr_t>(chunk.data);
+        std::size_t const offset = ((base + m_offset + align - 1) & ~(align - 1)) - base;
+
+        if (offset + bytes <= chunk.size)
+        {
+            m_used += offset + bytes - m_offset;
+            m_highWater = std::max(m_highWater, m_used);
+            m_offset = offset + bytes;
+            return chunk.data + offset;
+        }
+    }
+
+    addChunk(bytes + align);
+    return allocate(bytes, align);
+}
+
+void Arena::deallocate(void* p, std::size_t bytes)
+{
+    auto* const block = static_cast<char*>(p);
+
+    // The last allocation goes back to the chunk
+    if (!m_chunks.empty() && block + bytes == m_chunks.back().data + m_offset)
+    {
+        m_offset -= bytes;
+        m_used -= bytes;
+        return;
+    }
+
+    if (bytes < MIN_RECYCLED || reinterpret_cast<std::uintptr_t>(p) % alignof(FreeBlock) != 0)
+        return;
+
+    auto* const free = static_cast<FreeBlock*>(p);
+    auto& list = m_free[sizeClass(bytes)];
+
+    free->next = list;
+    free->size = bytes;
+    list = free;
+}
+
+// First block of the size class that is large enough and aligned
+void* Arena::recycle(std::size_t bytes, std::size_t align)
+{
+    for (FreeBlock** link = &m_free[sizeClass(bytes)]; *link; link = &(*link)->next)
+    {
+        FreeBlock* const block = *link;
+
+        if (block->size >= bytes && reinterpret_cast<std::uintptr_t>(block) % align == 0)
+        {
+            *link = block->next;
+            return block;
+        }
+    }
+
+    return nullptr;
+}
+
+void Arena::addChunk(std::size_t minsize)
+{
+    // Doubling keeps the number of chunks logarithmic in the size of the solve
+    std::size_t size = m_chunks.empty() ? std::max(MIN_CHUNK, m_nextChunk) : m_chunks.back().size * 2;
+    size = std::max(size, minsize);
+
+    // What is left of the last chunk is out of reach from now on
+    if (!m_chunks.empty())
+        m_used += m_chunks.back().size - m_offset;
+
+    m_chunks.push_back({ static_cast<char*>(::operator new(size)), size });
+    m_offset = 0;
+    m_reserved += size;
+    m_nextChunk = 0;
+}
+
+void Arena::freeChunks()
+{
+    for (auto const& chunk : m_chunks)
+        ::operator delete(chunk.data);
+
+    m_chunks.clear();
+    m_offset = 0;
+    m_reserved = 0;
+    std::fill(std::begin(m_free), std::end(m_free), nullptr);
+}
+
+void Arena::reset()
+{
+    // Enough for a solve like this one
+    std::size_t const keep = std::min(std::max(m_highWater, MIN_CHUNK), MAX_RETAINED);
+
+    m_peak = m_highWater;
+    m_offset = 0;
+    m_used = 0;
+    m_highWater = 0;
+    std::fill(std::begin(m_free), std::end(m_free), nullptr);
+
+    if (m_chunks.size() == 1 && m_chunks.front().size <= 2 * keep && m_chunks.front().size <= MAX_RETAINED)
+        return;
+
+    freeChunks();
+    m_nextChunk = keep;
+}
+
+void Arena::release()
+{
+    freeChunks();
+    m_nextChunk = 0;
+}
+
+Arena& Arena::local()
+{
+    static thread_local Arena arena;
+    return arena;
+}
+
+Arena* Arena::current()
+{
+    return t_current;
+}
+
+ArenaScope::ArenaScope(Mode mode)
+    : m_saved(Arena::t_current)
+    , m_mode(mode)
+{
+    if (mode == Attached)
+    {
+        Arena::t_current = &Arena::local();
+        ++Arena::t_depth;
+    }
+    else
+        Arena::t_current = nullptr;
+}
+
+ArenaScope::~ArenaScope()
+{
+    Arena::t_current = m_saved;
+
+    if (m_mode == Attached && --Arena::t_depth == 0)
+        Arena::local().reset();
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#include "stats.h"
+
+// Memory for the state storage of a solve: allocating bumps a pointer, and everything goes at
+// once when the solve ends. Large blocks given back, the storage a container outgrew, are reused
+// by the next allocation of about their size, so containers growing side by side take turns with
+// the same memory. Every thread has one and keeps a chunk across solves, so the next task on a
+// worker reuses the pages of the previous one.
+class Arena
+{
+public:
+
+    // Kept for the next solve at most, anything above goes back to the heap
+    static constexpr std::size_t MAX_RETAINED = std::size_t(256) << 20;
+
+    // Smaller blocks given back are left where they are
+    static constexpr std::size_t MIN_RECYCLED = std::size_t(4) << 10;
+
+    Arena() = default;
+    ~Arena();
+
+    Arena(Arena const&) = delete;
+    Arena& operator=(Arena const&) = delete;
+
+    void* allocate(std::size_t bytes, std::size_t align);
+    void deallocate(void* p, std::size_t bytes);
+
+    // Forgets all allocations. One chunk no larger than the solve took is kept, otherwise the
+    // chunks go and the next solve gets a single one of that size when it first allocates.
+    void reset();
+
+    // Gives all chunks back to the heap, for a thread that has nothing to solve for now.
+    // Not during a solve.
+    void release();
+
+    std::size_t used() const { return m_used; }
+    std::size_t reserved() const { return m_reserved; }
+
+    // Most of the chunks in use at a time during the last solve
+    std::size_t peak() const { return m_peak; }
+
+    // The arena of the calling thread
+    static Arena& local();
+
+    // The arena of the solve running on the calling thread, null outside of one
+    static Arena* current();
+
+private:
+
+    struct Chunk
+    {
+        char* data;
+        std::size_t size;
+    };
+
+    // Kept in the block given back
+    struct FreeBlock
+    {
+        FreeBlock* next;
+        std::size_t size;
+    };
+
+    // Blocks of more than half of 2^n bytes up to 2^n are recycled in list n
+    static constexpr unsigned NUM_CLASSES = 64;
+
+    static unsigned sizeClass(std::size_t bytes);
+
+    void* recycle(std::size_t bytes, std::size_t align);
+    void addChunk(std::size_t minsize);
+    void freeChunks();
+
+private:
+    std::vector<Chunk> m_chunks;
+    std::size_t m_offset = 0;       // in the last chunk
+    std::size_t m_used = 0;         // taken from the chunks during this solve
+    std::size_t m_highWater = 0;    // most of it at a time
+    std::size_t m_reserved = 0;
+    std::size_t m_peak = 0;
+    std::size_t m_nextChunk = 0;    // size of the first chunk of the next solve when none was kept
+    FreeBlock* m_free[NUM_CLASSES] = {};
+
+    friend class ArenaScope;
+    static thread_local Arena* t_current;
+    static thread_local unsigned t_depth;
+};
+
+// Makes the thread's arena current for the duration of a solve and resets it at the end of the
+// outermost one. A detached scope sends allocations to the heap instead, for storage that other
+// threads allocate from.
+class ArenaScope
+{
+public:
+
+    enum Mode { Attached, Detached };
+
+    explicit ArenaScope(Mode mode = Attached);
+    ~ArenaScope();
+
+    ArenaScope(ArenaScope const&) = delete;
+    ArenaScope& operator=(ArenaScope const&) = delete;
+
+private:
+    Arena* m_saved;
+    Mode m_mode;
+};
+
+// Allocator of the arena current when it is constructed, the heap if there is none.
+// What it hands out is counted as allocated by the thread.
+template<typename T>
+class ArenaAllocator
+{
+public:
+
+    using value_type = T;
+
+    ArenaAllocator() : m_arena(Arena::current()) {}
+
+    template<typename U>
+    ArenaAllocator(ArenaAllocator<U> const& other) : m_arena(other.arena()) {}
+
+    T* allocate(std::size_t n)
+    {
+        stats::allocated(n * sizeof(T));
+
+        if (m_arena)
+            return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T)));
+
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n)
+    {
+        if (m_arena)
+            m_arena->deallocate(p, n * sizeof(T));
+        else
+            ::operator delete(p);
+    }
+
+    Arena* arena() const { return m_arena; }
+
+    template<typename U>
+    bool operator==(ArenaAllocator<U> const& other) const { return m_arena == other.arena(); }
+
+    template<typename U>
+    bool operator!=(ArenaAllocator<U> const& other) const { return m_arena != other.arena(); }
+
+private:
+    Arena* m_arena;
+};
+
+template<typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
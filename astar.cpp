@@ -0,0 +1,150 @@
+#include "solver.h"
+
+#include <queue>
+#include <stdexcept>
+
+#include "heuristic.h"
+
+namespace
+{
+
+struct OpenEntry
+{
+    unsigned f;
+    Distance g;
+    StateId id;
+    bool cached;    // f is exact, the rest of the way is in the solution cache
+};
+
+// Lowest f first, deeper states first among equal f: they are closer to a goal
+struct OpenOrder
+{
+    bool operator()(OpenEntry const& l, OpenEntry const& r) const
+    {
+        return l.f > r.f || (l.f == r.f && l.g < r.g);
+    }
+};
+
+using OpenList = std::priority_queue<OpenEntry, ArenaVector<OpenEntry>, OpenOrder>;
+
+// Follows the cached moves from the last key to a goal. Where an entry has been evicted
+// in the meantime, a plain BFS finishes the way.
+void appendCachedPath(BoardPtr const& board, SolutionCache& cache, std::vector<StateKey>& keys)
+{
+    for (;;)
+    {
+        auto const entry = cache.find(board->layout(), keys.back());
+
+        if (!entry)
+        {
+            auto const rest = solveBfs(board, keys.back());
+            keys.insert(keys.end(), rest.keys.begin() + 1, rest.keys.end());
+            return;
+        }
+
+        if (entry->distance == 0)
+            return;
+
+        keys.push_back(entry->next);
+    }
+}
+
+} // namespace
+
+// A state found in the cache is not expanded: it is queued with its exact cost, and once it is
+// popped no path through the states left open can be shorter.
+StatePath solveAStar(BoardPtr const& board, StateKey const& inikey, SolutionCache* cache, PatternDatabase const* patterns,
+                     unsigned pruning, unsigned bound)
+{
+    StateStore store(board);
+    Heuristic const h(*board, patterns);
+    Pruning rules(*board, pruning);
+
+    ArenaVector<Distance> depths;
+    ArenaVector<StateId> preds;
+    ArenaVector<bool> closed;
+    OpenList open;
+    SuccessorHashes hashes;
+    std::size_t expanded = 0;
+
+    // Exact distance if the key is cached, otherwise the heuristic
+    auto estimate = [&](StateKey const& key, bool& cached) {
+        auto const entry = cache ? cache->find(board->layout(), key) : std::nullopt;
+        cached = entry.has_value();
+        return cached ? entry->distance : h(key);
+    };
+
+    StateId const inistate = store.add(inikey);
+    bool inicached;
+    auto const inih = estimate(inikey, inicached);
+
+    if (inih == Heuristic::INFINITE)
+        throw std::runtime_error("No solution");
+
+    depths.push_back(0);
+    preds.push_back(INVALID_STATE);
+    closed.push_back(false);
+    open.push({ inih, 0, inistate, inicached });
+
+    while (!open.empty())
+    {
+        auto const top = open.top();
+        open.pop();
+
+        // The heuristic is consistent, so the first time a state is popped its depth is final
+        if (closed[top.id])
+            continue;
+
+        closed[top.id] = true;
+
+        if (top.cached || store.isFinal(top.id))
+        {
+            auto solpath = tracePath(store, preds, inistate, top.id);
+            solpath.board = board;
+            solpath.expanded = expanded;
+            solpath.pruned = rules.counts();
+
+            if (top.cached)
+                appendCachedPath(board, *cache, solpath.keys);
+
+            return solpath;
+        }
+
+        ++expanded;
+
+        auto const depth = static_cast<Distance>(top.g + 1);
+
+        auto succs = store.successors(top.id, hashes);
+
+        if (rules.enabled())
+            rules.apply(preds[top.id] != INVALID_STATE ? &store.key(preds[top.id]) : nullptr, succs, &hashes);
+
+        for (std::size_t i = 0; i < succs.size(); ++i)
+        {
+            auto const& key = succs[i];
+            StateId const id = store.add(key, hashes[i]);
+
+            if (id == depths.size())
+            {
+                depths.push_back(UNREACHABLE);
+                preds.push_back(INVALID_STATE);
+                closed.push_back(false);
+            }
+
+            if (closed[id] || depth >= depths[id])
+                continue;
+
+            bool cached;
+            auto const hv = estimate(key, cached);
+
+            if (hv == Heuristic::INFINITE || depth + hv > bound)
+                continue;
+
+            depths[id] = depth;
+            preds[id] = top.id;
+            open.push({ depth + hv, depth, id, cached });
+        }
+    }
+
+    throw std::runtime_error("No solution");
+}
@@ -0,0 +1,940 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <numeric>
+#include <random>
+#include <algorithm>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#include <sys/resource.h>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include <boost/container_hash/hash.hpp>
+
+#include "task.h"
+#include "statestore.h"
+#include "puzzle.h"
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+using Trace = std::vector<StateKey>;
+
+constexpr int REPEATS = 5;
+
+// Keys in the order a full expansion of the state space looks them up
+Trace makeTrace(Task const& task)
+{
+    Trace trace;
+    StateStore store(task.board());
+
+    trace.push_back(task.initialKey());
+    store.add(task.initialKey());
+
+    for (StateId id = 0; id < store.size(); ++id)
+    {
+        for (auto const& key : store.state(id).adjacent())
+        {
+            trace.push_back(key);
+            store.add(key);
+        }
+    }
+
+    return trace;
+}
+
+// Best of several runs, nanoseconds per lookup
+template<typename Registry, typename Insert>
+double measure(Trace const& trace, Insert insert)
+{
+    double best = std::numeric_limits<double>::max();
+    std::size_t numstates = 0;
+
+    for (int i = 0; i < REPEATS; ++i)
+    {
+        Registry reg;
+
+        auto const start = Clock::now();
+        for (std::size_t i = 0; i < trace.size(); ++i)
+            insert(reg, i);
+        auto const elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+        best = std::min(best, elapsed / static_cast<double>(trace.size()));
+        numstates = reg.size();
+    }
+
+    std::cout << std::setw(10) << numstates;
+
+    return best;
+}
+
+// Node based map against the flat registry, given the hash the searches take from the parent of a
+// key, and the flat registry working out the whole Zobrist hash of every key on top of that.
+// The speedup is the one of the searches, map against flat.
+void benchRegistries(std::string const& filename)
+{
+    Task task(filename);
+    auto const trace = makeTrace(task);
+    auto const& board = *task.board();
+
+    // Worked out beforehand here, as the searches get them from the parents
+    std::vector<StateHash> hashes;
+    for (auto const& key : trace)
+        hashes.push_back(board.hash(key));
+
+    using MapRegistry = std::unordered_map<StateKey, StateId, boost::hash<StateKey>>;
+
+    std::cout << std::left << std::setw(16) << filename << std::right << std::setw(10) << trace.size();
+
+    auto const tmap = measure<MapRegistry>(trace, [&trace](MapRegistry& reg, std::size_t i) {
+        reg.emplace(trace[i], static_cast<StateId>(reg.size()));
+    });
+
+    auto const tflat = measure<StateRegistry>(trace, [&trace, &hashes](StateRegistry& reg, std::size_t i) {
+        reg.insert(trace[i], hashes[i]);
+    });
+
+    auto const thashed = measure<StateRegistry>(trace, [&trace, &board](StateRegistry& reg, std::size_t i) {
+        reg.insert(trace[i], board.hash(trace[i]));
+    });
+
+    std::cout << std::fixed << std::setprecision(1)
+              << std::setw(14) << tmap << std::setw(14) << tflat << std::setw(14) << thashed
+              << std::setw(10) << tmap / tflat << 'x' << std::endl;
+}
+
+void printStatesHeader()
+{
+    std::cout << std::left << std::setw(16) << "task" << std::right << std::setw(8) << "key B"
+              << std::setw(10) << "states" << std::setw(10) << "B/state" << std::setw(12) << "kstates/s" << std::endl;
+}
+
+// The size of a packed key, then the whole state space expanded breadth first into a StateStore
+// the way the searches fill one: state storage per state, and states expanded per second
+void benchStates(std::string const& filename)
+{
+    Task task(filename);
+    ArenaScope arena;
+    StateStore store(task.board());
+    SuccessorHashes hashes;
+
+    auto const start = Clock::now();
+
+    store.add(task.initialKey());
+
+    for (StateId id = 0; id < store.size(); ++id)
+    {
+        auto const succs = store.successors(id, hashes);
+
+        for (std::size_t i = 0; i < succs.size(); ++i)
+            store.add(succs[i], hashes[i]);
+    }
+
+    auto const elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    auto const numstates = static_cast<double>(store.size());
+
+    std::cout << std::left << std::setw(16) << filename << std::right << std::setw(8) << sizeof(StateKey)
+              << std::setw(10) << store.size() << std::fixed << std::setprecision(1)
+              << std::setw(10) << static_cast<double>(Arena::local().used()) / numstates
+              << std::setw(12) << numstates / elapsed / 1e3 << std::endl;
+}
+
+void printRegistriesHeader()
+{
+    std::cout << std::left << std::setw(16) << "task" << std::right << std::setw(10) << "lookups"
+              << std::setw(10) << "map size" << std::setw(10) << "flat size" << std::setw(11) << "+hash size"
+              << std::setw(14) << "map ns/op" << std::setw(14) << "flat ns/op" << std::setw(14) << "+hash ns/op"
+              << std::setw(11) << "speedup" << std::endl;
+}
+
+constexpr Solver allSolvers[] = { Solver::BFS, Solver::AStar, Solver::IDAStar, Solver::Bidirectional, Solver::ParallelBFS, Solver::ExternalBFS };
+
+void printSolversHeader()
+{
+    std::cout << std::left << std::setw(16) << "task" << std::right << std::setw(6) << "moves";
+
+    for (auto solver : allSolvers)
+    {
+        std::cout << std::setw(13) << std::string(solverName(solver)) + " exp"
+                  << std::setw(12) << std::string(solverName(solver)) + " ms";
+    }
+
+    std::cout << std::endl;
+}
+
+// Expanded states and wall time of every solver side by side
+void benchSolvers(std::string const& filename)
+{
+    Task task(filename);
+    std::size_t moves = 0;
+
+    std::cout << std::left << std::setw(16) << filename << std::right;
+
+    std::ostringstream row;
+    row << std::fixed << std::setprecision(1);
+
+    for (auto solver : allSolvers)
+    {
+        auto const start = Clock::now();
+        auto const solpath = task.Solve({ solver });
+        auto const elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        if (moves == 0)
+            moves = solpath.keys.size() - 1;
+        else if (moves != solpath.keys.size() - 1)
+            throw std::runtime_error(std::string(solverName(solver)) + " found a different number of moves");
+
+        row << std::setw(13) << solpath.expanded << std::setw(12) << elapsed;
+    }
+
+    std::cout << std::setw(6) << moves << row.str() << std::endl;
+}
+
+void printThreadsHeader()
+{
+    std::cout << std::left << std::setw(16) << "task" << std::right << std::setw(8) << "solver"
+              << std::setw(9) << "threads" << std::setw(6) << "moves" << std::setw(12) << "ms"
+              << std::setw(10) << "speedup" << std::endl;
+}
+
+// Parallel BFS from one thread up to all hardware threads (at least four), against the sequential BFS
+void benchThreads(std::string const& filename)
+{
+    Task task(filename);
+
+    auto run = [&task, &filename](SolverConfig const& config, double base) {
+        auto const start = Clock::now();
+        auto const solpath = task.Solve(config);
+        auto const elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        std::cout << std::left << std::setw(16) << filename << std::right
+                  << std::setw(8) << solverName(config.solver) << std::setw(9) << config.threads
+                  << std::setw(6) << solpath.keys.size() - 1
+                  << std::fixed << std::setprecision(1) << std::setw(12) << elapsed
+                  << std::setprecision(2) << std::setw(9) << (base > 0 ? base / elapsed : 1.0) << 'x' << std::endl;
+
+        return elapsed;
+    };
+
+    auto const base = run({ Solver::BFS, 1 }, 0);
+    auto const maxthreads = std::max(4u, std::thread::hardware_concurrency());
+
+    for (unsigned threads = 1; threads <= maxthreads; threads *= 2)
+        run({ Solver::ParallelBFS, threads }, base);
+}
+
+void printPatternsHeader()
+{
+    std::cout << std::left << std::setw(16) << "task" << std::right << std::setw(6) << "moves"
+              << std::setw(10) << "bfs exp" << std::setw(12) << "astar exp" << std::setw(10) << "pdb exp"
+              << std::setw(9) << "vs bfs" << std::setw(9) << "vs astar"
+              << std::setw(9) << "subsets" << std::setw(10) << "build ms"
+              << std::setw(10) << "astar ms" << std::setw(9) << "pdb ms" << std::endl;
+}
+
+// Expanded states of A* with pattern databases against BFS and A* with the road heuristic alone
+void benchPatterns(std::string const& filename)
+{
+    Task task(filename);
+
+    auto timed = [](auto run) {
+        auto const start = Clock::now();
+        auto result = run();
+        return std::make_pair(std::move(result), std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    };
+
+    auto const bfs = task.Solve({ Solver::BFS });
+    auto const astar = timed([&]() { return task.Solve({ Solver::AStar }); });
+    auto const pdb = timed([&]() { return std::make_shared<PatternDatabase>(*task.board(), 0); });
+    auto const informed = timed([&]() { return solveAStar(task.board(), task.initialKey(), nullptr, pdb.first.get()); });
+
+    if (informed.first.keys.size() != bfs.keys.size() || astar.first.keys.size() != bfs.keys.size())
+        throw std::runtime_error("A* found a different number of moves");
+
+    std::cout << std::left << std::setw(16) << filename << std::right << std::setw(6) << bfs.keys.size() - 1
+              << std::setw(10) << bfs.expanded << std::setw(12) << astar.first.expanded << std::setw(10) << informed.first.expanded
+              << std::fixed << std::setprecision(1)
+              << std::setw(8) << static_cast<double>(bfs.expanded) / std::max<std::size_t>(1, informed.first.expanded) << 'x'
+              << std::setw(8) << static_cast<double>(astar.first.expanded) / std::max<std::size_t>(1, informed.first.expanded) << 'x'
+              << std::setw(9) << pdb.first->numSubsets() << std::setw(10) << pdb.second
+              << std::setw(10) << astar.second << std::setw(9) << informed.second << std::endl;
+}
+
+void printPruningHeader()
+{
+    std::cout << std::left << std::setw(16) << "task" << std::right << std::setw(8) << "solver"
+              << std::setw(6) << "moves" << std::setw(12) << "expanded" << std::setw(12) << "pruned exp"
+              << std::setw(10) << "ratio";
+
+    for (std::size_t r = 0; r < NUM_PRUNE_RULES; ++r)
+        std::cout << std::setw(12) << pruneRuleName(static_cast<PruneRule>(r));
+
+    std::cout << std::setw(10) << "ms" << std::setw(11) << "pruned ms" << std::endl;
+}
+
+// Expanded states of the solvers that prune, without and with every rule, and what each rule removed
+void benchPruning(std::string const& filename)
+{
+    Task task(filename);
+
+    for (auto solver : { Solver::BFS, Solver::AStar, Solver::IDAStar })
+    {
+        SolverConfig config{ solver };
+
+        auto start = Clock::now();
+        auto const plain = task.Solve(config);
+        auto const tplain = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        config.pruning = pruneRulesFromNames("all");
+
+        start = Clock::now();
+        auto const pruned = task.Solve(config);
+        auto const tpruned = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        if (plain.keys.size() != pruned.keys.size())
+            throw std::runtime_error(std::string(solverName(solver)) + " found a different number of moves with pruning");
+
+        std::cout << std::left << std::setw(16) << filename << std::right << std::setw(8) << solverName(solver)
+                  << std::setw(6) << plain.keys.size() - 1 << std::setw(12) << plain.expanded << std::setw(12) << pruned.expanded
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(9) << static_cast<double>(plain.expanded) / std::max<std::size_t>(1, pruned.expanded) << 'x';
+
+        for (auto count : pruned.pruned)
+            std::cout << std::setw(12) << count;
+
+        std::cout << std::setprecision(1) << std::setw(10) << tplain << std::setw(11) << tpruned << std::endl;
+    }
+}
+
+// Puzzle on a fully connected grid of 8x8 junctions with the pets scattered by a fixed seed
+std::string makePuzzle(std::size_t numpets)
+{
+    constexpr int JUNCTIONS = 8;
+    constexpr int SIDE = 2 * JUNCTIONS - 1;
+
+    std::string text;
+
+    for (int row = 0; row < SIDE; ++row)
+    {
+        for (int col = 0; col < SIDE; ++col)
+            text.push_back(row % 2 == 0 ? (col % 2 == 0 ? ROAD : WAY) : (col % 2 == 0 ? WAY : NOWAY));
+
+        text.push_back('\n');
+    }
+
+    std::vector<int> junctions(JUNCTIONS * JUNCTIONS);
+    std::iota(junctions.begin(), junctions.end(), 0);
+    std::shuffle(junctions.begin(), junctions.end(), std::mt19937(static_cast<unsigned>(numpets)));
+
+    auto at = [&](int junction) -> char& {
+        return text[static_cast<std::size_t>(2 * (junction / JUNCTIONS) * (SIDE + 1) + 2 * (junction % JUNCTIONS))];
+    };
+
+    for (std::size_t i = 0; i < numpets; ++i)
+    {
+        at(junctions[2 * i]) = static_cast<char>('a' + i);
+        at(junctions[2 * i + 1]) = static_cast<char>('A' + i);
+    }
+
+    at(junctions[2 * numpets]) = CAR;
+
+    return text;
+}
+
+void printKernelsHeader()
+{
+    std::cout << std::right << std::setw(6) << "pets" << std::setw(10) << "states"
+              << std::setw(16) << "generic Msucc/s" << std::setw(16) << "hashed Msucc/s"
+              << std::setw(10) << "speedup" << std::setw(16) << "batch Msucc/s" << std::setw(10) << "speedup" << std::endl;
+}
+
+// Successor generation over the first states of a breadth first search, generic code against the
+// kernels the searches expand states with: one key at a time through the move masks and in chunks
+// of keys, both working out the hashes of the successors from the one of their parent
+void benchKernels(std::string const& numpets)
+{
+    constexpr std::size_t MAX_STATES = 200000;
+
+    auto const text = makePuzzle(std::stoul(numpets));
+    Task task{ std::string_view(text) };
+    auto const& board = *task.board();
+    StateStore store(task.board());
+
+    store.add(task.initialKey());
+    for (StateId id = 0; id < store.size() && store.size() < MAX_STATES; ++id)
+    {
+        for (auto const& key : adjacentGeneric(board, store.key(id)))
+            store.add(key);
+    }
+
+    std::vector<StateKey> keys;
+    std::vector<StateHash> hashes;
+
+    for (StateId id = 0; id < store.size(); ++id)
+    {
+        keys.push_back(store.key(id));
+        hashes.push_back(board.hash(keys.back()));
+    }
+
+    auto measure = [&](auto adjacent) {
+        double best = std::numeric_limits<double>::max();
+        std::size_t total = 0;
+
+        for (int i = 0; i < REPEATS; ++i)
+        {
+            total = 0;
+            auto const start = Clock::now();
+
+            for (StateId id = 0; id < keys.size(); ++id)
+                total += adjacent(id).size();
+
+            best = std::min(best, std::chrono::duration<double>(Clock::now() - start).count());
+        }
+
+        return static_cast<double>(total) / best / 1e6;
+    };
+
+    SuccessorHashes succhashes;
+
+    for (StateId id = 0; id < keys.size(); ++id)
+    {
+        auto const succs = adjacentHashed(board, keys[id], hashes[id], succhashes);
+
+        if (adjacentGeneric(board, keys[id]) != succs)
+            throw std::runtime_error("Hashed and generic successors differ");
+
+        for (std::size_t i = 0; i < succs.size(); ++i)
+        {
+            if (succhashes[i] != board.hash(succs[i]))
+                throw std::runtime_error("Wrong successor hash");
+        }
+    }
+
+    constexpr std::size_t CHUNK = 1024;
+
+    std::vector<StateKey> succs;
+    std::vector<StateHash> outhashes;
+    std::vector<std::uint32_t> offsets;
+
+    adjacentBatch(board, keys.data(), keys.size(), succs, offsets, hashes.data(), &outhashes);
+    auto const numsuccs = succs.size();
+
+    for (StateId id = 0; id < keys.size(); ++id)
+    {
+        auto const expected = adjacentGeneric(board, keys[id]);
+
+        if (!std::equal(expected.begin(), expected.end(), succs.begin() + offsets[id], succs.begin() + offsets[id + 1]))
+            throw std::runtime_error("Batch and generic successors differ");
+
+        for (auto i = offsets[id]; i < offsets[id + 1]; ++i)
+        {
+            if (outhashes[i] != board.hash(succs[i]))
+                throw std::runtime_error("Wrong batch successor hash");
+        }
+    }
+
+    auto const generic = measure([&](StateId id) { return adjacentGeneric(board, keys[id]); });
+    auto const hashed = measure([&](StateId id) { return adjacentHashed(board, keys[id], hashes[id], succhashes); });
+
+    double best = std::numeric_limits<double>::max();
+
+    for (int i = 0; i < REPEATS; ++i)
+    {
+        auto const start = Clock::now();
+
+        for (std::size_t begin = 0; begin < keys.size(); begin += CHUNK)
+        {
+            adjacentBatch(board, keys.data() + begin, std::min(CHUNK, keys.size() - begin), succs, offsets,
+                          hashes.data() + begin, &outhashes);
+        }
+
+        best = std::min(best, std::chrono::duration<double>(Clock::now() - start).count());
+    }
+
+    auto const batch = static_cast<double>(numsuccs) / best / 1e6;
+
+    std::cout << std::setw(6) << numpets << std::setw(10) << keys.size() << std::fixed << std::setprecision(1)
+              << std::setw(16) << generic << std::setw(16) << hashed
+              << std::setprecision(2) << std::setw(9) << hashed / generic << 'x'
+              << std::setprecision(1) << std::setw(16) << batch
+              << std::setprecision(2) << std::setw(9) << batch / generic << 'x' << std::endl;
+}
+
+// Square grid of the given side with every road in place, up to 26 pets spread along the diagonal
+std::string makeGrid(int side)
+{
+    side |= 1;
+
+    std::string text;
+    text.reserve(static_cast<std::size_t>(side) * static_cast<std::size_t>(side + 1));
+
+    for (int row = 0; row < side; ++row)
+    {
+        for (int col = 0; col < side; ++col)
+        {
+            if (row % 2 == 0)
+                text.push_back(col % 2 == 0 ? ROAD : WAY);
+            else
+                text.push_back(col % 2 == 0 ? WAY : NOWAY);
+        }
+
+        text.push_back('\n');
+    }
+
+    auto const junctions = static_cast<std::size_t>(side / 2 + 1);
+    auto const line = static_cast<std::size_t>(side + 1);
+    auto at = [&](std::size_t jrow, std::size_t jcol) -> char& { return text[2 * jrow * line + 2 * jcol]; };
+
+    auto const numpets = std::min<std::size_t>(26, junctions - 1);
+
+    for (std::size_t i = 0; i < numpets; ++i)
+    {
+        std::size_t const j = i * (junctions - 1) / numpets;
+        at(j, j) = static_cast<char>('a' + i);
+        at(j, j + 1) = static_cast<char>('A' + i);
+    }
+
+    at(junctions - 1, 0) = CAR;
+
+    return text;
+}
+
+// What puzzles were parsed like before: a string per line, then a vector per row
+std::size_t parseByLines(std::string const& text)
+{
+    std::istringstream is(text);
+    std::vector<std::string> lines;
+    std::vector<std::vector<char>> streets;
+    std::map<char, Pet::Builder> builders;
+
+    for (std::string line; std::getline(is, line); )
+        lines.push_back(line);
+
+    for (std::size_t row = 0; row < lines.size(); ++row)
+    {
+        std::vector<char> street;
+
+        for (std::size_t col = 0; col < lines[row].size(); ++col)
+        {
+            char const c = lines[row][col];
+
+            if (isAnimalOrHouse(c))
+            {
+                builders[Pet::asAnimalName(c)].addPos(c, { static_cast<int>(row), static_cast<int>(col) });
+                street.push_back(ROAD);
+            }
+            else
+                street.push_back(c == CAR ? ROAD : c);
+        }
+
+        streets.push_back(std::move(street));
+    }
+
+    return streets.size() * streets.front().size();
+}
+
+void printParseHeader()
+{
+    std::cout << std::right << std::setw(8) << "side" << std::setw(10) << "MB"
+              << std::setw(14) << "lines MB/s" << std::setw(14) << "flat MB/s"
+              << std::setw(10) << "speedup" << std::endl;
+}
+
+// Parsing only, the road graph of such grids is far too large to build
+void benchParse(std::string const& side)
+{
+    auto const text = makeGrid(std::stoi(side));
+    auto const mb = static_cast<double>(text.size()) / (1 << 20);
+
+    auto best = [&](auto parse) {
+        double best = std::numeric_limits<double>::max();
+
+        for (int i = 0; i < REPEATS; ++i)
+        {
+            auto const start = Clock::now();
+            parse();
+            best = std::min(best, std::chrono::duration<double>(Clock::now() - start).count());
+        }
+
+        return best;
+    };
+
+    std::size_t cells = 0;
+    auto const tlines = best([&]() { cells = parseByLines(text); });
+    auto const tflat = best([&]() {
+        auto const puzzle = parsePuzzle(text);
+
+        if (static_cast<std::size_t>(puzzle.streets.height() * puzzle.streets.width()) != cells)
+            throw std::runtime_error("Parsers disagree on the grid size");
+    });
+
+    std::cout << std::setw(8) << side << std::fixed << std::setprecision(1) << std::setw(10) << mb
+              << std::setw(14) << mb / tlines << std::setw(14) << mb / tflat
+              << std::setw(9) << tlines / tflat << 'x' << std::endl;
+}
+
+// Puzzle generated on a grid of junctions. A random spanning tree keeps every junction reachable,
+// each other road between neighbouring junctions is there with the given density.
+struct PuzzleSpec
+{
+    int junctions = 6;          // on a side
+    double density = 0.5;
+    std::size_t pets = 4;
+    int capacity = MAX_CAPTURED;
+    unsigned seeds = 3;         // puzzles generated, seeded 1 to seeds
+};
+
+// "junctions=6,density=0.5,pets=4,capacity=4,seeds=3", any of them left out keeps its default
+PuzzleSpec parseSpec(std::string const& text)
+{
+    PuzzleSpec spec;
+    std::istringstream is(text);
+    std::string item;
+
+    while (std::getline(is, item, ','))
+    {
+        auto const eq = item.find('=');
+        auto const name = item.substr(0, eq);
+        auto const value = eq == std::string::npos ? std::string() : item.substr(eq + 1);
+
+        if (name == "junctions")
+            spec.junctions = std::stoi(value);
+        else if (name == "density")
+            spec.density = std::stod(value);
+        else if (name == "pets")
+            spec.pets = std::stoul(value);
+        else if (name == "capacity")
+            spec.capacity = std::stoi(value);
+        else if (name == "seeds")
+            spec.seeds = static_cast<unsigned>(std::stoul(value));
+        else
+            throw std::invalid_argument("Unknown puzzle parameter " + name);
+    }
+
+    if (spec.junctions < 2 || spec.pets < 1 || spec.pets > 26
+            || 2 * spec.pets + 1 > static_cast<std::size_t>(spec.junctions * spec.junctions))
+        throw std::invalid_argument("No room for the pets in " + text);
+
+    return spec;
+}
+
+std::string generatePuzzle(PuzzleSpec const& spec, unsigned seed)
+{
+    int const side = 2 * spec.junctions - 1;
+    std::mt19937 rng(seed);
+
+    std::string text;
+
+    for (int row = 0; row < side; ++row)
+    {
+        for (int col = 0; col < side; ++col)
+            text.push_back(row % 2 == 0 && col % 2 == 0 ? ROAD : NOWAY);
+
+        text.push_back('\n');
+    }
+
+    auto cell = [&](int row, int col) -> char& {
+        return text[static_cast<std::size_t>(row * (side + 1) + col)];
+    };
+
+    // Roads between neighbouring junctions, by the junction they start from and their direction
+    struct Edge { int from; int to; };
+    std::vector<Edge> edges;
+    int const n = spec.junctions;
+
+    for (int j = 0; j < n * n; ++j)
+    {
+        if (j % n + 1 < n)
+            edges.push_back({ j, j + 1 });
+        if (j / n + 1 < n)
+            edges.push_back({ j, j + n });
+    }
+
+    std::shuffle(edges.begin(), edges.end(), rng);
+
+    std::vector<int> parent(static_cast<std::size_t>(n * n));
+    std::iota(parent.begin(), parent.end(), 0);
+
+    auto root = [&](int j) {
+        while (parent[j] != j)
+            j = parent[j] = parent[parent[j]];
+        return j;
+    };
+
+    std::bernoulli_distribution extra(spec.density);
+
+    for (auto const& e : edges)
+    {
+        bool const joins = root(e.from) != root(e.to);
+
+        if (joins)
+            parent[root(e.from)] = root(e.to);
+
+        if (joins || extra(rng))
+            cell(e.from / n + e.to / n, e.from % n + e.to % n) = WAY;
+    }
+
+    std::vector<int> junctions(static_cast<std::size_t>(n * n));
+    std::iota(junctions.begin(), junctions.end(), 0);
+    std::shuffle(junctions.begin(), junctions.end(), rng);
+
+    auto at = [&](int junction) -> char& { return cell(2 * (junction / n), 2 * (junction % n)); };
+
+    for (std::size_t i = 0; i < spec.pets; ++i)
+    {
+        at(junctions[2 * i]) = static_cast<char>('a' + i);
+        at(junctions[2 * i + 1]) = static_cast<char>('A' + i);
+    }
+
+    at(junctions[2 * spec.pets]) = CAR;
+
+    return text;
+}
+
+// Starts over the peak resident set size of the process, where the kernel allows it
+void resetPeakRss()
+{
+#if defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+    std::ofstream("/proc/self/clear_refs") << "5";
+}
+
+// Peak resident set size in megabytes
+double peakRss()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+
+    while (std::getline(status, line))
+    {
+        if (line.compare(0, 6, "VmHWM:") == 0)
+            return std::stod(line.substr(6)) / 1024;
+    }
+
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_maxrss) / 1024;
+}
+
+// Resident set size now, in megabytes
+double currentRss()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+
+    while (std::getline(status, line))
+    {
+        if (line.compare(0, 6, "VmRSS:") == 0)
+            return std::stod(line.substr(6)) / 1024;
+    }
+
+    return 0;
+}
+
+long minorFaults()
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_minflt;
+}
+
+void printArenaHeader()
+{
+    std::cout << std::left << std::setw(16) << "task" << std::setw(9) << "solver" << std::right
+              << std::setw(10) << "heap ms" << std::setw(10) << "arena ms"
+              << std::setw(12) << "heap flt" << std::setw(12) << "arena flt"
+              << std::setw(10) << "heap RSS" << std::setw(10) << "arena RSS" << std::setw(10) << "arena MB" << std::endl;
+}
+
+// Every single threaded solver REPEATS times with its states on the heap, then from the arena:
+// best time, page faults per solve, the memory the process holds on to afterwards, and the most
+// of the arena a solve had in use
+void benchArena(std::string const& filename)
+{
+    Task task(filename);
+
+    for (auto solver : { Solver::BFS, Solver::AStar, Solver::IDAStar, Solver::Bidirectional })
+    {
+        std::cout << std::left << std::setw(16) << filename << std::setw(9) << solverName(solver) << std::right;
+
+        std::ostringstream times;
+        std::ostringstream faults;
+        std::ostringstream rss;
+
+        times << std::fixed << std::setprecision(1);
+        faults << std::fixed << std::setprecision(0);
+        rss << std::fixed << std::setprecision(1);
+
+        for (bool arena : { false, true })
+        {
+            SolverConfig config{ solver };
+            config.arena = arena;
+
+            double best = std::numeric_limits<double>::max();
+            auto const before = minorFaults();
+
+            for (int i = 0; i < REPEATS; ++i)
+            {
+                auto const start = Clock::now();
+                task.Solve(config);
+                best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+            }
+
+            times << std::setw(10) << best;
+            faults << std::setw(12) << static_cast<double>(minorFaults() - before) / REPEATS;
+            rss << std::setw(10) << currentRss();
+        }
+
+        std::cout << times.str() << faults.str() << rss.str()
+                  << std::setw(10) << std::fixed << std::setprecision(1) << Arena::local().peak() / double(1 << 20) << std::endl;
+    }
+}
+
+void printSuiteHeader()
+{
+    std::cout << std::right << std::setw(5) << "seed" << std::setw(9) << "solver" << std::setw(7) << "moves"
+              << std::setw(11) << "expanded" << std::setw(11) << "mean ms" << std::setw(9) << "sd ms"
+              << std::setw(10) << "min ms" << std::setw(11) << "Mstates/s" << std::setw(9) << "RSS MB" << std::endl;
+}
+
+// Every solver on generated puzzles, REPEATS runs each: time to solution, expanded states per second, peak memory
+void benchSuite(std::string const& specs)
+{
+    auto const spec = parseSpec(specs);
+
+    std::cout << "# " << specs << std::endl;
+
+    for (unsigned seed = 1; seed <= spec.seeds; ++seed)
+    {
+        Puzzle puzzle = parsePuzzle(generatePuzzle(spec, seed));
+        auto const board = std::make_shared<Board const>(std::move(puzzle.streets), std::move(puzzle.pets), spec.capacity);
+        auto const inikey = board->initialKey(puzzle.car);
+        std::size_t moves = 0;
+
+        for (auto solver : allSolvers)
+        {
+            std::vector<double> times;
+            StatePath solpath;
+
+            resetPeakRss();
+
+            for (int i = 0; i < REPEATS; ++i)
+            {
+                auto const start = Clock::now();
+                solpath = solve({ solver }, board, inikey);
+                times.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+            }
+
+            auto const rss = peakRss();
+            auto const mean = std::accumulate(times.begin(), times.end(), 0.0) / REPEATS;
+            auto const var = std::accumulate(times.begin(), times.end(), 0.0,
+                    [mean](double acc, double t) { return acc + (t - mean) * (t - mean); }) / (REPEATS - 1);
+
+            if (moves == 0)
+                moves = solpath.keys.size() - 1;
+            else if (moves != solpath.keys.size() - 1)
+                throw std::runtime_error(std::string(solverName(solver)) + " found a different number of moves");
+
+            std::cout << std::setw(5) << seed << std::setw(9) << solverName(solver) << std::setw(7) << moves
+                      << std::setw(11) << solpath.expanded << std::fixed << std::setprecision(2)
+                      << std::setw(11) << mean << std::setw(9) << std::sqrt(var)
+                      << std::setw(10) << *std::min_element(times.begin(), times.end())
+                      << std::setw(11) << static_cast<double>(solpath.expanded) / mean / 1e3
+                      << std::setprecision(1) << std::setw(9) << rss << std::endl;
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::cout << "Usage: " << argv[0] << " states|registry|solvers|threads|patterns|pruning|arena <task_filename> [...]\n"
+                  << "       " << argv[0] << " parse <grid_side> [...]\n"
+                  << "       " << argv[0] << " kernels <number_of_pets> [...]\n"
+                  << "       " << argv[0] << " suite junctions=N,density=D,pets=N,capacity=N,seeds=N [...]" << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    std::string const mode = argv[1];
+    void (*bench)(std::string const&) = nullptr;
+
+    if (mode == "states")
+    {
+        printStatesHeader();
+        bench = benchStates;
+    }
+    else if (mode == "registry")
+    {
+        printRegistriesHeader();
+        bench = benchRegistries;
+    }
+    else if (mode == "solvers")
+    {
+        printSolversHeader();
+        bench = benchSolvers;
+    }
+    else if (mode == "threads")
+    {
+        printThreadsHeader();
+        bench = benchThreads;
+    }
+    else if (mode == "patterns")
+    {
+        printPatternsHeader();
+        bench = benchPatterns;
+    }
+    else if (mode == "pruning")
+    {
+        printPruningHeader();
+        bench = benchPruning;
+    }
+    else if (mode == "kernels")
+    {
+        printKernelsHeader();
+        bench = benchKernels;
+    }
+    else if (mode == "suite")
+    {
+        printSuiteHeader();
+        bench = benchSuite;
+    }
+    else if (mode == "arena")
+    {
+        printArenaHeader();
+        bench = benchArena;
+    }
+    else if (mode == "parse")
+    {
+        printParseHeader();
+        bench = benchParse;
+    }
+    else
+    {
+        std::cerr << "Unknown benchmark " << mode << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    for (int i = 2; i < argc; ++i)
+    {
+        try {
+            bench(argv[i]);
+        } catch (std::exception& e) {
+            std::cerr << argv[i] << ": " << e.what() << std::endl;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
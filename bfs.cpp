@@ -0,0 +1,247 @@
+#include "solver.h"
+
+#include <deque>
+#include <functional>
+#include <memory>
+
+#include <boost/graph/breadth_first_search.hpp>
+#include <boost/graph/visitors.hpp>
+#include <boost/iterator/counting_iterator.hpp>
+#include <boost/property_map/property_map.hpp>
+
+#include "stategraph.h"
+#include "colorarray.h"
+#include "checkpoint.h"
+
+namespace
+{
+
+struct Predecessors
+{
+    using value_type = boost::graph_traits<StateGraph>::vertex_descriptor;
+    using reference = value_type&;
+    using key_type = boost::graph_traits<StateGraph>::vertex_descriptor;
+    using category = boost::writable_property_map_tag;
+    using data_type = ArenaVector<value_type>;
+
+    friend void put(Predecessors& pmap, key_type k, value_type v)
+    {
+        auto& data = *pmap.data;
+
+        if (k >= data.size())
+            data.resize(k + 1, INVALID_STATE);
+
+        data[k] = v;
+
+        if (*pmap.goal == INVALID_STATE && pmap.store->isFinal(k))
+            *pmap.goal = k;
+    }
+
+    Predecessors(data_type* dptr, StateStore const* store, StateId* goal) : data(dptr), store(store), goal(goal) {}
+
+private:
+    data_type* data;
+    StateStore const* store;
+    StateId* goal;
+};
+
+
+// Looks empty as soon as a goal has been recorded, which ends breadth_first_visit right there
+struct Queue
+{
+    using value_type = 	boost::graph_traits<StateGraph>::vertex_descriptor;
+    using size_type = std::size_t;
+
+    explicit Queue(StateId const* goal) : goal(goal) {}
+
+    void push(const value_type& t)	{ data.push_back(t); ++nextlevel; }
+
+    // The states of a depth are all queued by the time the first of them is popped
+    void pop()
+    {
+        if (remaining == 0)
+        {
+            remaining = nextlevel;
+            nextlevel = 0;
+            stats::frontier(remaining);
+
+            if (atDepth)
+                atDepth(data.front());
+        }
+
+        if (atPop)
+            atPop();
+
+        --remaining;
+        data.pop_front();
+    }
+    value_type& top() { return data.front(); }
+    const value_type& top() const { return data.front(); }
+    size_type size() const { return data.size(); }
+    bool empty() const { return data.empty() || *goal != INVALID_STATE; }
+
+    void release() { std::deque<value_type>().swap(data); }
+
+    // Called with the first state of a depth before it is expanded, then before every state expanded
+    std::function<void(value_type)> atDepth;
+    std::function<void()> atPop;
+
+private:
+    std::deque<value_type> data;
+    StateId const* goal;
+    size_type remaining = 0;    // states of the current depth not popped yet
+    size_type nextlevel = 0;    // states of the next depth queued so far
+};
+
+struct Colors
+{
+    using value_type = boost::default_color_type;
+    using reference = value_type&;
+    using key_type = boost::graph_traits<StateGraph>::vertex_descriptor;
+    using category = boost::read_write_property_map_tag;
+    using data_type = ColorArray;
+
+    friend void put(Colors& pmap, key_type k, value_type v)
+    {
+        pmap.data->put(k, v);
+    }
+
+    friend value_type get(Colors& pmap, key_type k)
+    {
+        return pmap.data->get(k);
+    }
+
+    Colors(data_type* dptr) : data(dptr) {}
+
+private:
+    data_type* data;
+};
+
+// States taken off the queue, those are the ones whose successors get generated
+struct CountExamined
+{
+    using event_filter = boost::on_examine_vertex;
+
+    template<typename Vertex, typename Graph>
+    void operator()(Vertex, Graph const&) { ++*count; }
+
+    std::size_t* count;
+};
+
+} // namespace
+
+// With checkpoints, the search state is saved at the start of a depth once the interval is over.
+// A resumed search has the same states under the same ids and queues them in the same order,
+// so it goes on exactly as the interrupted one would have.
+StatePath solveBfs(BoardPtr const& board, StateKey const& inikey, unsigned pruning, unsigned bound,
+                   CheckpointConfig const& checkpoint)
+{
+    StateStore store(board);
+    store.reserve(StateRegistry::estimateStates(board->numCells(), board->pets().size()));
+
+    Predecessors::data_type preds;
+    Pruning rules(*board, pruning);
+    Heuristic const h(*board);
+    DepthBound depths{ h, bound, h.ceiling(), { 0 } };
+    StateGraph g(store, rules.enabled() ? &rules : nullptr, &preds, bound != NO_BOUND ? &depths : nullptr);
+    StateId const inistate = store.add(inikey);
+    StateId goal = INVALID_STATE;
+    Queue buf(&goal);
+    Colors::data_type colors;
+    std::size_t expanded = 0;
+
+    preds.reserve(store.capacity());
+    colors.reserve(store.capacity());
+
+    if (store.isFinal(inistate))
+        return { board, { inikey } };
+
+    std::string const filename = checkpoint.dir.empty() ? std::string() : checkpointFile(checkpoint.dir, *board, inikey);
+    BfsSnapshot resumed;
+
+    if (checkpoint.resume && !filename.empty()
+            && (!loadCheckpoint(filename, resumed) || !resumed.matches(*board, inikey, bound, pruning)))
+        resumed = BfsSnapshot();
+
+    boost::counting_iterator<StateId> first(inistate), last(inistate + 1);
+
+    if (!resumed.keys.empty())
+    {
+        // Every state known but the queued ones has been expanded, the search picks up at the queue
+        for (StateId id = 0; id < resumed.keys.size(); ++id)
+        {
+            // Only a checkpoint with the same key twice gets here, it can't be searched from.
+            // No writer exists yet, the fresh search has the file to itself.
+            if (store.add(resumed.keys[id]) != id)
+            {
+                CheckpointConfig fresh = checkpoint;
+                fresh.resume = false;
+                return solveBfs(board, inikey, pruning, bound, fresh);
+            }
+
+            colors.put(id, boost::black_color);
+        }
+
+        preds.assign(resumed.preds.begin(), resumed.preds.end());
+        expanded = resumed.expanded;
+
+        // A predecessor is always discovered first
+        depths.depths.resize(store.size());
+        for (StateId id = 1; id < store.size(); ++id)
+            depths.depths[id] = static_cast<Distance>(depths.depths[preds[id]] + 1);
+
+        stats::resumed(store.size());
+
+        first = boost::counting_iterator<StateId>(resumed.frontier);
+        last = boost::counting_iterator<StateId>(static_cast<StateId>(store.size()));
+        resumed = BfsSnapshot();
+    }
+
+    std::unique_ptr<CheckpointWriter> writer;
+
+    if (!filename.empty())
+    {
+        // States before the end of the queue keep their keys and predecessors for good
+        writer = std::make_unique<CheckpointWriter>(filename, checkpoint.interval,
+            [&store, &preds](BfsSnapshot& snapshot, StateId from, StateId to) {
+                for (StateId id = from; id < to; ++id)
+                    snapshot.keys.push_back(store.key(id));
+
+                snapshot.preds.insert(snapshot.preds.end(), preds.begin() + std::min<std::size_t>(from, preds.size()),
+                                      preds.begin() + std::min<std::size_t>(to, preds.size()));
+                snapshot.preds.resize(to, INVALID_STATE);
+            });
+
+        buf.atDepth = [&](StateId front) {
+            if (writer->due())
+                writer->start({ board->layout(), inikey, bound, pruning, expanded, front, {}, {} }, store.size());
+        };
+        buf.atPop = [&writer]() { writer->step(); };
+    }
+
+    auto visitor = boost::make_bfs_visitor(std::make_pair(
+                                               boost::record_predecessors(Predecessors(&preds, &store, &goal),
+                                                                          boost::on_tree_edge()),
+                                               CountExamined{ &expanded }));
+
+    boost::breadth_first_visit(g, first, last, buf, visitor, Colors(&colors));
+
+    // Solved or proven unsolvable, nothing left to resume. A search that ends with an exception
+    // leaves the last checkpoint behind.
+    if (writer)
+        writer->remove();
+
+    if (goal == INVALID_STATE)
+        throw std::runtime_error("No solution");
+
+    // Only the keys and predecessors are needed from here on
+    buf.release();
+    colors = Colors::data_type();
+
+    auto solpath = tracePath(store, preds, inistate, goal);
+    solpath.board = board;
+    solpath.expanded = expanded;
+    solpath.pruned = rules.counts();
+
+    return solpath;
+}
@@ -0,0 +1,153 @@
+#include "solver.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+
+// Depth and link towards the origin of one search direction, per StateId
+struct Direction
+{
+    ArenaVector<Distance> depths;
+    ArenaVector<StateId> links;
+    ArenaVector<StateId> frontier;
+    Distance level = 0;
+
+    void track(std::size_t numstates)
+    {
+        if (depths.size() < numstates)
+        {
+            depths.resize(numstates, UNREACHABLE);
+            links.resize(numstates, INVALID_STATE);
+        }
+    }
+
+    bool seen(StateId id) const { return depths[id] != UNREACHABLE; }
+};
+
+} // namespace
+
+// Every state the backward search has reached is at its exact distance from the goal,
+// so all of them go to the solution cache along with their link towards the goal.
+StatePath solveBidirectional(BoardPtr const& board, StateKey const& inikey, SolutionCache* cache)
+{
+    StateStore store(board);
+    Direction fwd;
+    Direction bwd;
+    ArenaVector<StateId> next;
+    SuccessorHashes hashes;
+    std::size_t expanded = 0;
+
+    StateId const inistate = store.add(inikey);
+
+    // Without pets there are no final keys to search back from
+    if (store.isFinal(inistate))
+        return { board, { inikey } };
+
+    fwd.track(store.size());
+    fwd.depths[inistate] = 0;
+    fwd.frontier.push_back(inistate);
+
+    for (auto const& key : board->finalKeys())
+    {
+        StateId const id = store.add(key);
+        bwd.track(store.size());
+
+        if (!bwd.seen(id))
+        {
+            bwd.depths[id] = 0;
+            bwd.frontier.push_back(id);
+        }
+    }
+
+    fwd.track(store.size());
+
+    if (bwd.seen(inistate))
+        return { board, { inikey } };
+
+    unsigned best = UNREACHABLE;
+    StateId meet = INVALID_STATE;
+
+    // Any path shorter than fwd.level + bwd.level has a state both directions have already seen
+    while (!fwd.frontier.empty() && !bwd.frontier.empty() && best > static_cast<unsigned>(fwd.level + bwd.level))
+    {
+        bool const forward = fwd.frontier.size() <= bwd.frontier.size();
+        auto& dir = forward ? fwd : bwd;
+        auto const& other = forward ? bwd : fwd;
+
+        next.clear();
+
+        for (StateId const id : dir.frontier)
+        {
+            ++expanded;
+
+            auto const depth = static_cast<Distance>(dir.depths[id] + 1);
+
+            auto visit = [&](StateKey const& key, StateHash hash) {
+                StateId const n = store.add(key, hash);
+                fwd.track(store.size());
+                bwd.track(store.size());
+
+                if (dir.seen(n))
+                    return;
+
+                dir.depths[n] = depth;
+                dir.links[n] = id;
+                next.push_back(n);
+
+                if (other.seen(n) && static_cast<unsigned>(depth + other.depths[n]) < best)
+                {
+                    best = depth + other.depths[n];
+                    meet = n;
+                }
+            };
+
+            // Predecessors are hashed whole, successors take the hash of the state they come from
+            if (forward)
+            {
+                auto const succs = store.successors(id, hashes);
+
+                for (std::size_t i = 0; i < succs.size(); ++i)
+                    visit(succs[i], hashes[i]);
+            }
+            else
+            {
+                for (auto const& key : store.state(id).previous())
+                    visit(key, board->hash(key));
+            }
+        }
+
+        dir.frontier.swap(next);
+        ++dir.level;
+    }
+
+    if (meet == INVALID_STATE)
+        throw std::runtime_error("No solution");
+
+    stats::Reconstruction timer;
+    StatePath solpath{ board, {}, expanded };
+
+    for (StateId s = meet; s != inistate; s = fwd.links[s])
+        solpath.keys.push_back(store.key(s));
+
+    solpath.keys.push_back(inikey);
+    std::reverse(solpath.keys.begin(), solpath.keys.end());
+
+    for (StateId s = meet; bwd.depths[s] != 0; )
+    {
+        s = bwd.links[s];
+        solpath.keys.push_back(store.key(s));
+    }
+
+    if (cache)
+    {
+        for (StateId id = 0, numstates = static_cast<StateId>(bwd.depths.size()); id < numstates; ++id)
+        {
+            if (bwd.seen(id))
+                cache->insert(board->layout(), store.key(id), { bwd.depths[id], bwd.depths[id] ? store.key(bwd.links[id]) : StateKey() });
+        }
+    }
+
+    return solpath;
+}
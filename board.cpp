@@ -0,0 +1,83 @@
+#include "board.h"
+
+#include <stdexcept>
+#include <string>
+
+#include <boost/container_hash/hash.hpp>
+
+Board::Board(Streets&& streets, Pets&& pets, int capacity)
+    : m_streets(std::move(streets))
+    , m_pets(std::move(pets))
+    , m_roads(m_streets)
+    , m_capacity(capacity)
+{
+    if (capacity < 1)
+        throw std::invalid_argument("The car must have room for a pet");
+
+    m_houses.reserve(m_pets.size());
+    m_starts.reserve(m_pets.size());
+    for (auto const& pet : m_pets)
+    {
+        m_houses.push_back(cellOf(pet.housePosition()));
+        m_starts.push_back(cellOf(pet.animalPosition()));
+    }
+
+    m_codec = KeyCodec(numCells(), m_pets.size());
+
+    for (std::size_t i = 0; i < m_pets.size(); ++i)
+    {
+        m_codec.setPet(m_petbits, i, { INVALID_CELL, true });
+        m_codec.setPet(m_solved, i, { m_houses[i], false });
+    }
+
+    m_moves = MoveMasks(*this);
+    m_zobrist = Zobrist(*this);
+
+    std::size_t layout = 0;
+    boost::hash_combine(layout, m_streets.height());
+    boost::hash_combine(layout, m_streets.width());
+
+    for (int row = 0; row < m_streets.height(); ++row)
+        boost::hash_range(layout, m_streets.row(row), m_streets.row(row) + m_streets.width());
+
+    boost::hash_range(layout, m_houses.begin(), m_houses.end());
+    boost::hash_combine(layout, m_capacity);
+
+    m_layout = layout;
+}
+
+StateKey Board::initialKey(Car const& car) const
+{
+    Cell const carcell = cellOf(car);
+
+    if (carcell == INVALID_CELL)
+        throw std::runtime_error(std::string("Invalid position of ") + CAR);
+
+    StateKey key;
+
+    m_codec.setCar(key, carcell);
+
+    for (std::size_t i = 0; i < m_pets.size(); ++i)
+        m_codec.setPet(key, i, { m_starts[i], false });
+
+    return key;
+}
+
+std::vector<StateKey> Board::finalKeys() const
+{
+    StateKey solved;
+
+    for (std::size_t i = 0; i < m_pets.size(); ++i)
+        m_codec.setPet(solved, i, { m_houses[i], false });
+
+    std::vector<StateKey> keys;
+    keys.reserve(m_houses.size());
+
+    for (Cell house : m_houses)
+    {
+        m_codec.setCar(solved, house);
+        keys.push_back(solved);
+    }
+
+    return keys;
+}
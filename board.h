@@ -0,0 +1,91 @@
+#pragma once
+
+#include "definitions.h"
+#include "streets.h"
+#include "pet.h"
+#include "statekey.h"
+#include "roadgraph.h"
+#include "kernels.h"
+#include "zobrist.h"
+#include "stats.h"
+
+// Everything about a puzzle that stays the same during a search.
+// Shared by all states of one Task.
+class Board
+{
+public:
+
+    Board(Streets&& streets, Pets&& pets, int capacity = MAX_CAPTURED);
+
+    Streets const& streets() const { return m_streets; }
+    Pets const& pets() const { return m_pets; }
+    KeyCodec const& codec() const { return m_codec; }
+    RoadGraph const& roads() const { return m_roads; }
+
+    // Hash of what puzzles must share for their states to mean the same: streets, houses and capacity
+    std::uint64_t layout() const { return m_layout; }
+
+    std::size_t numCells() const { return m_roads.numCells(); }
+
+    // Pets that fit in the car at once
+    int capacity() const { return m_capacity; }
+
+    Cell house(std::size_t pet) const { return m_houses[pet]; }
+    Cell start(std::size_t pet) const { return m_starts[pet]; }
+
+    Cell cellOf(Position const& pos) const { return m_roads.cellOf(pos); }
+    Position positionOf(Cell cell) const { return m_roads.positionOf(cell); }
+
+    // Key of the starting state: every animal at its initial position, nobody captured
+    StateKey initialKey(Car const& car) const;
+
+    // Successors through the move masks, hashes left out
+    Successors adjacent(StateKey const& key) const
+    {
+        SuccessorHashes hashes;
+        return adjacent(key, 0, hashes);
+    }
+
+    // Successors with their hashes, from the hash of the key
+    Successors adjacent(StateKey const& key, StateHash hash, SuccessorHashes& hashes) const
+    {
+        auto succs = adjacentHashed(*this, key, hash, hashes);
+        stats::generated(succs.size());
+        return succs;
+    }
+
+    // Masks for the batch successor kernel
+    MoveMasks const& moveMasks() const { return m_moves; }
+
+    Zobrist const& zobrist() const { return m_zobrist; }
+
+    // Hash of a key from scratch; successors get theirs from their parent through adjacent()
+    StateHash hash(StateKey const& key) const { return m_zobrist(m_codec, key); }
+
+    // Every pet at home, wherever the car is
+    bool isFinal(StateKey const& key) const
+    {
+        return (key.words[0] & m_petbits.words[0]) == m_solved.words[0]
+                && (key.words[1] & m_petbits.words[1]) == m_solved.words[1];
+    }
+
+    // Keys of all solved states: every pet at home and the car at the house
+    // where the last one has just been dropped off
+    std::vector<StateKey> finalKeys() const;
+
+private:
+    Streets m_streets;
+    Pets m_pets;
+    RoadGraph m_roads;
+    std::vector<Cell> m_houses;
+    std::vector<Cell> m_starts;
+    KeyCodec m_codec;
+    int m_capacity;
+    MoveMasks m_moves;
+    Zobrist m_zobrist;
+    StateKey m_petbits;     // all bits of the pet fields
+    StateKey m_solved;      // pet fields of a solved state
+    std::uint64_t m_layout = 0;
+};
+
+using BoardPtr = std::shared_ptr<Board const>;
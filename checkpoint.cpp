@@ -0,0 +1,286 @@
+#include "checkpoint.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+constexpr char MAGIC[8] = { 'P', 'D', 'B', 'F', 'S', '0', '0', '2' };
+
+// States copied into a snapshot per expansion
+constexpr std::size_t COPY_CHUNK = 4096;
+
+// Followed by the keys and the predecessors, both as they are in memory
+struct Header
+{
+    char magic[8];
+    std::uint64_t layout;
+    std::uint64_t inikey[StateKey::NUM_WORDS];
+    std::uint32_t bound;
+    std::uint32_t pruning;
+    std::uint64_t expanded;
+    std::uint64_t numstates;
+    std::uint64_t frontier;
+    std::uint64_t checksum;     // of the keys and predecessors
+};
+
+// Catches damage rather than tampering
+std::uint64_t checksum(void const* data, std::size_t bytes, std::uint64_t h)
+{
+    auto const* p = static_cast<unsigned char const*>(data);
+
+    for (; bytes >= sizeof(std::uint64_t); bytes -= sizeof(std::uint64_t), p += sizeof(std::uint64_t))
+    {
+        std::uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        h = (h ^ word) * 0x100000001b3ull;
+        h ^= h >> 29;
+    }
+
+    for (; bytes > 0; --bytes, ++p)
+        h = (h ^ *p) * 0x100000001b3ull;
+
+    return h;
+}
+
+template<typename T>
+std::uint64_t checksum(std::vector<T> const& v, std::uint64_t h)
+{
+    return checksum(v.data(), v.size() * sizeof(T), h);
+}
+
+template<typename T>
+void writeArray(std::ofstream& ofs, std::vector<T> const& v)
+{
+    ofs.write(reinterpret_cast<char const*>(v.data()), static_cast<std::streamsize>(v.size() * sizeof(T)));
+}
+
+template<typename T>
+void readArray(std::ifstream& ifs, std::vector<T>& v, std::uint64_t size)
+{
+    v.resize(size);
+    ifs.read(reinterpret_cast<char*>(v.data()), static_cast<std::streamsize>(v.size() * sizeof(T)));
+}
+
+// Returns the size of the file
+std::size_t writeSnapshot(std::string const& filename, BfsSnapshot const& snapshot)
+{
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.layout = snapshot.layout;
+    std::copy(snapshot.inikey.words.begin(), snapshot.inikey.words.end(), header.inikey);
+    header.bound = snapshot.bound;
+    header.pruning = snapshot.pruning;
+    header.expanded = snapshot.expanded;
+    header.numstates = snapshot.keys.size();
+    header.frontier = snapshot.frontier;
+    header.checksum = checksum(snapshot.preds, checksum(snapshot.keys, header.layout));
+
+    std::string const tmpname = filename + ".tmp";
+    std::ofstream ofs(tmpname, std::ios::binary | std::ios::trunc);
+
+    if (!ofs)
+        throw std::runtime_error("Can't create " + tmpname);
+
+    ofs.write(reinterpret_cast<char const*>(&header), sizeof(header));
+    writeArray(ofs, snapshot.keys);
+    writeArray(ofs, snapshot.preds);
+    ofs.close();
+
+    if (ofs.fail())
+        throw std::runtime_error("Can't write " + tmpname);
+
+    fs::rename(tmpname, filename);
+
+    return sizeof(header) + snapshot.keys.size() * sizeof(StateKey) + snapshot.preds.size() * sizeof(StateId);
+}
+
+// Whether the ids of the snapshot can be searched from: the initial state comes first, every
+// other state comes after its predecessor, which has been expanded, and the queue isn't empty
+bool consistent(BfsSnapshot const& snapshot)
+{
+    auto const numstates = snapshot.keys.size();
+
+    if (numstates == 0 || snapshot.frontier >= numstates || snapshot.keys.front() != snapshot.inikey
+            || snapshot.preds.front() != INVALID_STATE)
+        return false;
+
+    for (StateId id = 1; id < numstates; ++id)
+    {
+        if (snapshot.preds[id] >= std::min(id, snapshot.frontier))
+            return false;
+    }
+
+    return true;
+}
+
+} // namespace
+
+bool BfsSnapshot::matches(Board const& board, StateKey const& key, unsigned searchbound, unsigned searchpruning) const
+{
+    return layout == board.layout() && inikey == key && bound == searchbound && pruning == searchpruning;
+}
+
+std::string checkpointFile(std::string const& dir, Board const& board, StateKey const& inikey)
+{
+    std::ostringstream name;
+    name << std::hex << std::setfill('0') << std::setw(16) << board.layout()
+         << '-' << std::setw(16) << board.hash(inikey) << ".ckpt";
+
+    return (fs::path(dir) / name.str()).string();
+}
+
+bool loadCheckpoint(std::string const& filename, BfsSnapshot& snapshot)
+{
+    std::ifstream ifs(filename, std::ios::binary);
+
+    if (!ifs)
+        return false;
+
+    Header header{};
+    ifs.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+    if (!ifs || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.numstates > INVALID_STATE)
+        throw std::runtime_error("Damaged checkpoint " + filename);
+
+    snapshot.layout = header.layout;
+    std::copy(header.inikey, header.inikey + StateKey::NUM_WORDS, snapshot.inikey.words.begin());
+    snapshot.bound = header.bound;
+    snapshot.pruning = header.pruning;
+    snapshot.expanded = header.expanded;
+    snapshot.frontier = static_cast<StateId>(std::min<std::uint64_t>(header.frontier, INVALID_STATE));
+
+    readArray(ifs, snapshot.keys, header.numstates);
+    readArray(ifs, snapshot.preds, header.numstates);
+
+    if (!ifs)
+        throw std::runtime_error("Damaged checkpoint " + filename);
+
+    return checksum(snapshot.preds, checksum(snapshot.keys, header.layout)) == header.checksum && consistent(snapshot);
+}
+
+CheckpointWriter::CheckpointWriter(std::string filename, double interval, Copy copy)
+    : m_filename(std::move(filename))
+    , m_interval(interval)
+    , m_copy(std::move(copy))
+    , m_last(std::chrono::steady_clock::now())
+{
+}
+
+CheckpointWriter::~CheckpointWriter()
+{
+    // The search ended some other way than remove(), so the last checkpoint stays for a resume.
+    // Its stats count all the same.
+    abandon();
+
+    try {
+        join();
+    } catch (std::exception&) {
+        // The search is over either way
+    }
+}
+
+bool CheckpointWriter::due() const
+{
+    return !m_busy && std::chrono::steady_clock::now() - m_last >= m_interval;
+}
+
+void CheckpointWriter::start(BfsSnapshot snapshot, std::size_t numstates)
+{
+    join();
+
+    auto const begin = std::chrono::steady_clock::now();
+
+    m_snapshot = std::move(snapshot);
+    m_snapshot.keys.reserve(numstates);
+    m_snapshot.preds.reserve(numstates);
+    m_numstates = numstates;
+    m_busy = true;
+    m_pending = true;
+    m_bytes = 0;
+    m_writeSeconds = 0;
+    m_last = std::chrono::steady_clock::now();
+    m_stallSeconds = std::chrono::duration<double>(m_last - begin).count();
+
+    step();
+}
+
+void CheckpointWriter::step()
+{
+    if (m_numstates == 0)
+        return;
+
+    auto const begin = std::chrono::steady_clock::now();
+    auto const first = m_snapshot.keys.size();
+    auto const last = std::min(first + COPY_CHUNK, m_numstates);
+
+    m_copy(m_snapshot, static_cast<StateId>(first), static_cast<StateId>(last));
+
+    if (last == m_numstates)
+    {
+        m_numstates = 0;
+        m_thread = std::thread([this]() {
+            auto const start = std::chrono::steady_clock::now();
+
+            try {
+                m_bytes = writeSnapshot(m_filename, m_snapshot);
+            } catch (...) {
+                m_error = std::current_exception();
+            }
+
+            m_snapshot = BfsSnapshot();
+            m_writeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            m_busy = false;
+        });
+    }
+
+    m_last = std::chrono::steady_clock::now();
+    m_stallSeconds += std::chrono::duration<double>(m_last - begin).count();
+}
+
+void CheckpointWriter::remove()
+{
+    abandon();
+    join();
+
+    std::error_code ec;
+    fs::remove(m_filename, ec);
+    fs::remove(m_filename + ".tmp", ec);
+}
+
+void CheckpointWriter::abandon()
+{
+    // Only a snapshot still being copied, one being written is left to finish
+    if (m_numstates != 0)
+    {
+        m_numstates = 0;
+        m_snapshot = BfsSnapshot();
+        m_busy = false;
+    }
+}
+
+void CheckpointWriter::join()
+{
+    if (m_thread.joinable())
+        m_thread.join();
+
+    if (!m_pending)
+        return;
+
+    m_pending = false;
+
+    // A failed write held up the search all the same
+    stats::checkpoint(m_error ? 0 : m_bytes, m_stallSeconds, m_writeSeconds);
+
+    if (m_error)
+        std::rethrow_exception(std::exchange(m_error, nullptr));
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "board.h"
+#include "stateregistry.h"
+
+// Search state of a breadth first search taken between two depths: every state discovered so
+// far in the order of their ids and the predecessor of each. States are queued in the order
+// they are discovered, so the queue of the next depth is the states from frontier on,
+// and all states before it have been expanded.
+struct BfsSnapshot
+{
+    std::uint64_t layout = 0;
+    StateKey inikey;
+    unsigned bound = 0;
+    unsigned pruning = 0;
+    std::uint64_t expanded = 0;
+    StateId frontier = 0;
+    std::vector<StateKey> keys;
+    std::vector<StateId> preds;
+
+    // Whether the snapshot belongs to a search of that puzzle with the same options
+    bool matches(Board const& board, StateKey const& key, unsigned searchbound, unsigned searchpruning) const;
+};
+
+// Checkpoint file of a puzzle in the directory
+std::string checkpointFile(std::string const& dir, Board const& board, StateKey const& inikey);
+
+// False if there is no checkpoint or its contents don't make a search state, throws if it is cut short
+bool loadCheckpoint(std::string const& filename, BfsSnapshot& snapshot);
+
+// Writes snapshots to the checkpoint file on a thread of its own, one at a time, no more often
+// than the interval. Every file is written aside and renamed over the previous one once complete,
+// so an interrupted write leaves the last checkpoint as it was.
+// The states of a snapshot never change once discovered, so they are copied a chunk at a time
+// between expansions while the search goes on, and the writing thread takes over when all are copied.
+// The time the search spends copying and the work of the writing thread go to the stats
+// of the search; a write that failed throws from the next call.
+class CheckpointWriter
+{
+public:
+
+    // Appends the keys and predecessors of the states from first to last to the snapshot
+    using Copy = std::function<void(BfsSnapshot& snapshot, StateId first, StateId last)>;
+
+    CheckpointWriter(std::string filename, double interval, Copy copy);
+    ~CheckpointWriter();
+
+    CheckpointWriter(CheckpointWriter const&) = delete;
+    CheckpointWriter& operator=(CheckpointWriter const&) = delete;
+
+    // The interval is over and the previous snapshot has been written
+    bool due() const;
+
+    // Starts a snapshot of numstates states, all but the keys and predecessors filled in
+    void start(BfsSnapshot snapshot, std::size_t numstates);
+
+    // Copies the next chunk of the snapshot in progress, if any, and starts writing it once complete
+    void step();
+
+    // Waits for the write in progress and deletes the checkpoint, the search is complete.
+    // Otherwise the checkpoint stays when the writer goes.
+    void remove();
+
+private:
+
+    // Gives up the snapshot being copied, if any
+    void abandon();
+    void join();
+
+private:
+    std::string m_filename;
+    std::chrono::duration<double> m_interval;
+    Copy m_copy;
+    std::chrono::steady_clock::time_point m_last;
+    std::thread m_thread;
+    std::atomic<bool> m_busy{ false };
+    BfsSnapshot m_snapshot;
+    std::size_t m_numstates = 0;    // of the snapshot being copied, 0 if there is none
+
+    // Of the snapshot in progress, taken over by the search thread when it is joined
+    double m_stallSeconds = 0;
+    double m_writeSeconds = 0;
+    std::size_t m_bytes = 0;
+    std::exception_ptr m_error;
+    bool m_pending = false;
+};
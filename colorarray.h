@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <boost/graph/properties.hpp>
+
+#include "arena.h"
+#include "stateregistry.h"
+
+// BFS colors of states packed 2 bits per StateId. Grows as states are discovered,
+// states past the end are white.
+class ColorArray
+{
+public:
+
+    using Color = boost::default_color_type;
+
+    Color get(StateId id) const
+    {
+        auto const word = id / STATES_PER_WORD;
+
+        if (word >= m_words.size())
+            return Color::white_color;
+
+        return fromBits((m_words[word] >> shift(id)) & MASK);
+    }
+
+    void put(StateId id, Color c)
+    {
+        auto const word = id / STATES_PER_WORD;
+
+        if (word >= m_words.size())
+            m_words.resize(word + 1, 0);
+
+        auto& w = m_words[word];
+        w = (w & ~(MASK << shift(id))) | (toBits(c) << shift(id));
+    }
+
+    void reserve(std::size_t numstates) { m_words.reserve(numstates / STATES_PER_WORD + 1); }
+
+private:
+
+    using Word = std::uint64_t;
+
+    static constexpr Word MASK = 3;
+    static constexpr std::size_t STATES_PER_WORD = sizeof(Word) * 8 / 2;
+
+    static unsigned shift(StateId id) { return static_cast<unsigned>(id % STATES_PER_WORD) * 2; }
+
+    static Word toBits(Color c)
+    {
+        switch (c)
+        {
+        case Color::white_color: return 0;
+        case Color::gray_color: return 1;
+        default: return 2;
+        }
+    }
+
+    static Color fromBits(Word bits)
+    {
+        switch (bits)
+        {
+        case 0: return Color::white_color;
+        case 1: return Color::gray_color;
+        default: return Color::black_color;
+        }
+    }
+
+private:
+    ArenaVector<Word> m_words;
+};
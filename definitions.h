@@ -2,11 +2,21 @@
 
 #include <vector>
 #include <memory>
+#include <cstdint>
+#include <cctype>
 
 using Position = std::pair<int, int>;
 using Car = Position;
 
+// Index of a junction (a cell with both coordinates even) in row-major order
+using Cell = std::uint16_t;
+
+// Number of car moves
+using Distance = std::uint16_t;
+
 constexpr Position INVALID_POSITION{ -1, -1 };
+constexpr Cell INVALID_CELL = 0xffff;
+constexpr Distance UNREACHABLE = 0xffff;
 constexpr char INVALID_NAME = '\0';
 
 constexpr char ROAD = '*';
@@ -14,11 +24,8 @@ constexpr char WAY  = '+';
 constexpr char NOWAY= ' ';
 constexpr char CAR  = '@';
 
+// Pets the car carries at once unless the board says otherwise
 constexpr int MAX_CAPTURED = 4;
 
-inline bool isAnimalOrHouse(char c) { return std::isalpha(c); }
-
-
-using Streets = std::vector<std::vector<char>>;
-using StreetsPtr = std::shared_ptr<Streets>;
+inline bool isAnimalOrHouse(char c) { return std::isalpha(static_cast<unsigned char>(c)); }
 
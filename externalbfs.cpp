@@ -0,0 +1,267 @@
+#include "solver.h"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <queue>
+#include <stdexcept>
+
+#include <unistd.h>
+
+#include "keyfile.h"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+constexpr std::size_t DEFAULT_MEMORY = std::size_t(256) << 20;
+
+// Frontier keys expanded at a time
+constexpr std::size_t EXPAND_CHUNK = 1024;
+
+// Directory of the files of one search, removed with everything in it
+class ScratchDir
+{
+public:
+
+    explicit ScratchDir(std::string const& parent)
+    {
+        static std::atomic<unsigned> counter{ 0 };
+
+        fs::path const base = parent.empty() ? fs::temp_directory_path() : fs::path(parent);
+        m_path = base / ("petdetective-" + std::to_string(::getpid()) + '-' + std::to_string(counter++));
+
+        fs::create_directories(m_path);
+    }
+
+    ~ScratchDir()
+    {
+        std::error_code ec;
+        fs::remove_all(m_path, ec);
+    }
+
+    ScratchDir(ScratchDir const&) = delete;
+    ScratchDir& operator=(ScratchDir const&) = delete;
+
+    std::string file(std::string const& name) const { return (m_path / name).string(); }
+
+private:
+    fs::path m_path;
+};
+
+// Reader positioned on its smallest key not yet consumed
+class Cursor
+{
+public:
+
+    explicit Cursor(std::string const& filename) : m_reader(filename) { advance(); }
+
+    bool valid() const { return m_valid; }
+    StateKey const& key() const { return m_key; }
+
+    void advance() { m_valid = m_reader.next(m_key); }
+
+    // True if the file has the key; keys are looked for in increasing order
+    bool contains(StateKey const& key)
+    {
+        while (m_valid && keyLess(m_key, key))
+            advance();
+
+        return m_valid && m_key == key;
+    }
+
+private:
+    KeyFileReader m_reader;
+    StateKey m_key;
+    bool m_valid = false;
+};
+
+void writeRun(std::vector<StateKey>& keys, std::string const& filename)
+{
+    std::sort(keys.begin(), keys.end(), keyLess);
+
+    KeyFileWriter writer(filename);
+    for (auto it = keys.begin(); it != keys.end(); ++it)
+    {
+        if (it == keys.begin() || *it != *(it - 1))
+            writer.write(*it);
+        else
+            stats::duplicate();
+    }
+    writer.close();
+
+    keys.clear();
+}
+
+// Finds a key of the layer file the car could have come from to the given state
+StateKey previousIn(Board const& board, std::string const& layer, StateKey const& key)
+{
+    auto prevs = State(board, key).previous();
+    std::sort(prevs.begin(), prevs.end(), keyLess);
+
+    Cursor cursor(layer);
+
+    for (auto const& prev : prevs)
+    {
+        if (cursor.contains(prev))
+            return prev;
+    }
+
+    throw std::logic_error("No predecessor in the previous layer");
+}
+
+} // namespace
+
+// Breadth first search holding only buffers in memory. Every layer is a sorted key file on disk.
+// Successors of the current layer fill a buffer of the size of the memory budget, which is
+// sorted and written as a run whenever it is full. The runs are then merged, and every key
+// already in an earlier layer is dropped on the way (delayed duplicate detection).
+// Picking up and dropping off pets cannot be undone, so states do not only come back
+// from the two previous layers; the merge checks against all of them, still one sequential read each.
+// The path is recovered backwards from the goal, looking for a predecessor in each layer in turn.
+StatePath solveExternalBfs(BoardPtr const& board, StateKey const& inikey, std::size_t memory, std::string const& tempdir)
+{
+    if (State(*board, inikey).isFinal())
+        return { board, { inikey } };
+
+    if (memory == 0)
+        memory = DEFAULT_MEMORY;
+
+    std::size_t const capacity = std::max(EXPAND_CHUNK * MAX_SUCCESSORS, memory / sizeof(StateKey));
+
+    ScratchDir dir(tempdir);
+    std::vector<std::string> layers;
+    std::vector<StateKey> buffer;
+    std::vector<StateKey> chunk;
+    std::vector<StateKey> succs;
+    std::vector<std::uint32_t> offsets;
+    std::size_t expanded = 0;
+    std::size_t layersize = 1;
+    StateKey goal;
+    bool found = false;
+
+    layers.push_back(dir.file("layer0"));
+    {
+        KeyFileWriter writer(layers.back());
+        writer.write(inikey);
+        writer.close();
+    }
+
+    while (!found)
+    {
+        stats::frontier(layersize);
+
+        std::vector<std::string> runs;
+
+        auto flushRun = [&]() {
+            runs.push_back(dir.file("run" + std::to_string(runs.size())));
+            writeRun(buffer, runs.back());
+        };
+
+        KeyFileReader frontier(layers.back());
+        StateKey key;
+        bool more = true;
+
+        while (more)
+        {
+            chunk.clear();
+            while (chunk.size() < EXPAND_CHUNK && (more = frontier.next(key)))
+                chunk.push_back(key);
+
+            adjacentBatch(*board, chunk.data(), chunk.size(), succs, offsets);
+            expanded += chunk.size();
+
+            if (buffer.size() + succs.size() > capacity)
+                flushRun();
+
+            buffer.insert(buffer.end(), succs.begin(), succs.end());
+        }
+
+        if (!buffer.empty())
+            flushRun();
+
+        // k-way merge of the runs, skipping keys seen in the run before or in any layer
+        std::vector<Cursor> merged;
+        std::vector<Cursor> seen;
+
+        merged.reserve(runs.size());
+        for (auto const& run : runs)
+            merged.emplace_back(run);
+
+        seen.reserve(layers.size());
+        for (auto const& layer : layers)
+            seen.emplace_back(layer);
+
+        auto later = [&merged](std::size_t l, std::size_t r) { return keyLess(merged[r].key(), merged[l].key()); };
+        std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(later)> heads(later);
+
+        for (std::size_t i = 0; i < merged.size(); ++i)
+        {
+            if (merged[i].valid())
+                heads.push(i);
+        }
+
+        layers.push_back(dir.file("layer" + std::to_string(layers.size())));
+        KeyFileWriter next(layers.back());
+        bool first = true;
+        StateKey last;
+
+        while (!heads.empty() && !found)
+        {
+            auto const i = heads.top();
+            heads.pop();
+
+            StateKey const key = merged[i].key();
+            merged[i].advance();
+
+            if (merged[i].valid())
+                heads.push(i);
+
+            if (!first && key == last)
+            {
+                stats::duplicate();
+                continue;
+            }
+
+            first = false;
+            last = key;
+
+            if (std::any_of(seen.begin(), seen.end(), [&key](Cursor& c) { return c.contains(key); }))
+            {
+                stats::duplicate();
+                continue;
+            }
+
+            next.write(key);
+
+            if (board->isFinal(key))
+            {
+                goal = key;
+                found = true;
+            }
+        }
+
+        next.close();
+
+        merged.clear();
+        for (auto const& run : runs)
+            fs::remove(run);
+
+        layersize = next.size();
+
+        if (layersize == 0)
+            throw std::runtime_error("No solution");
+    }
+
+    // The goal is in the last layer, each layer before holds one of its predecessors
+    stats::Reconstruction timer;
+    StatePath solpath{ board, { goal }, expanded };
+
+    for (std::size_t layer = layers.size() - 1; layer-- > 0; )
+        solpath.keys.push_back(previousIn(*board, layers[layer], solpath.keys.back()));
+
+    std::reverse(solpath.keys.begin(), solpath.keys.end());
+
+    return solpath;
+}
@@ -0,0 +1,150 @@
+#include "solver.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "heuristic.h"
+
+namespace
+{
+
+// Partial routes kept from one pickup or drop-off to the next
+constexpr std::size_t BEAM_WIDTH = 32;
+
+// A route of the beam and its moves so far plus the heuristic of its last state
+struct Route
+{
+    std::vector<StateKey> keys;
+    unsigned score;
+};
+
+// Whether no pet has been picked up or dropped off between the two states.
+// Pets in the car move along with it, so only the captured bits and the cells of the others count.
+bool samePets(KeyCodec const& codec, StateKey const& l, StateKey const& r)
+{
+    for (std::size_t i = 0, numpets = codec.numPets(); i < numpets; ++i)
+    {
+        PetPos const pl = codec.pet(l, i);
+        PetPos const pr = codec.pet(r, i);
+
+        if (pl.captured != pr.captured || (!pl.captured && pl.animal != pr.animal))
+            return false;
+    }
+
+    return true;
+}
+
+// Shortest drives from a state to every state where an animal is first picked up or dropped off.
+// Nothing changes for the pets on the way, so only the car cells are searched.
+std::vector<std::vector<StateKey>> drives(Board const& board, StateKey const& from, std::size_t& expanded)
+{
+    auto const& codec = board.codec();
+    StateRegistry seen;
+    std::vector<StateId> parents;
+    std::vector<std::vector<StateKey>> result;
+
+    SuccessorHashes hashes;
+
+    seen.insert(from, board.hash(from));
+    parents.push_back(INVALID_STATE);
+
+    for (StateId id = 0; id < seen.size(); ++id)
+    {
+        // Drives end at their event
+        if (id != 0 && !samePets(codec, from, seen.key(id)))
+            continue;
+
+        ++expanded;
+
+        auto const succs = board.adjacent(seen.key(id), seen.hash(id), hashes);
+
+        for (std::size_t i = 0; i < succs.size(); ++i)
+        {
+            auto const& key = succs[i];
+            auto const [next, inserted] = seen.insert(key, hashes[i]);
+
+            if (!inserted)
+                continue;
+
+            parents.push_back(id);
+
+            if (samePets(codec, from, key))
+                continue;
+
+            std::vector<StateKey> drive;
+            for (StateId s = next; s != 0; s = parents[s])
+                drive.push_back(seen.key(s));
+
+            std::reverse(drive.begin(), drive.end());
+            result.push_back(std::move(drive));
+        }
+    }
+
+    return result;
+}
+
+} // namespace
+
+// Beam search over the pickups and drop-offs instead of the single moves. Every route of the
+// beam is extended by the shortest drive to each of its next events, and the BEAM_WIDTH routes
+// with the smallest moves plus heuristic go on. Every event brings a pet closer to home,
+// so the search ends after two events per pet. The route found is legal but not always the shortest.
+StatePath solveGreedy(BoardPtr const& board, StateKey const& inikey)
+{
+    Heuristic const h(*board);
+    std::vector<Route> beam{ { { inikey }, h(inikey) } };
+    std::vector<Route> next;
+    std::size_t expanded = 0;
+
+    if (beam.front().score == Heuristic::INFINITE)
+        throw std::runtime_error("No solution");
+
+    while (!std::all_of(beam.begin(), beam.end(), [&board](Route const& r) { return board->isFinal(r.keys.back()); }))
+    {
+        next.clear();
+
+        for (auto& route : beam)
+        {
+            if (board->isFinal(route.keys.back()))
+            {
+                next.push_back(std::move(route));
+                continue;
+            }
+
+            for (auto& drive : drives(*board, route.keys.back(), expanded))
+            {
+                auto const hv = h(drive.back());
+
+                if (hv == Heuristic::INFINITE)
+                    continue;
+
+                Route extended{ route.keys, 0 };
+                extended.keys.insert(extended.keys.end(), drive.begin(), drive.end());
+                extended.score = static_cast<unsigned>(extended.keys.size() - 1) + hv;
+
+                next.push_back(std::move(extended));
+            }
+        }
+
+        if (next.empty())
+            throw std::runtime_error("No solution");
+
+        // Routes reaching the same state differ only in how long they are
+        std::stable_sort(next.begin(), next.end(), [](Route const& l, Route const& r) {
+            return l.keys.back().words < r.keys.back().words
+                    || (l.keys.back() == r.keys.back() && l.keys.size() < r.keys.size());
+        });
+        next.erase(std::unique(next.begin(), next.end(), [](Route const& l, Route const& r) {
+            return l.keys.back() == r.keys.back();
+        }), next.end());
+
+        std::stable_sort(next.begin(), next.end(), [](Route const& l, Route const& r) { return l.score < r.score; });
+
+        if (next.size() > BEAM_WIDTH)
+            next.resize(BEAM_WIDTH);
+
+        beam.swap(next);
+    }
+
+    return { board, std::move(beam.front().keys), expanded };
+}
@@ -0,0 +1,62 @@
+#include "heuristic.h"
+
+#include <algorithm>
+
+#include "patterndb.h"
+
+unsigned Heuristic::operator()(StateKey const& key) const
+{
+    auto const& codec = m_board.codec();
+    auto const& roads = m_board.roads();
+    Cell const car = codec.car(key);
+    unsigned bound = 0;
+
+    for (std::size_t i = 0, numpets = codec.numPets(); i < numpets; ++i)
+    {
+        Cell const house = m_board.house(i);
+        PetPos const pet = codec.pet(key, i);
+
+        if (pet.isHome(house))
+            continue;
+
+        Distance const tohouse = roads.distance(pet.animal, house);
+        Distance const toanimal = pet.captured ? 0 : roads.distance(car, pet.animal);
+
+        if (tohouse == UNREACHABLE || toanimal == UNREACHABLE)
+            return INFINITE;
+
+        bound = std::max(bound, static_cast<unsigned>(toanimal) + tohouse);
+    }
+
+    return m_patterns ? std::max(bound, (*m_patterns)(key)) : bound;
+}
+
+unsigned Heuristic::ceiling() const
+{
+    if (m_patterns)
+        return INFINITE;
+
+    auto const& roads = m_board.roads();
+    unsigned bound = 0;
+
+    // A waiting pet is at its start, a captured one wherever the car is
+    for (std::size_t i = 0, numpets = m_board.pets().size(); i < numpets; ++i)
+    {
+        Cell const house = m_board.house(i);
+        Cell const start = m_board.start(i);
+
+        for (Cell cell = 0; cell < roads.numCells(); ++cell)
+        {
+            Distance const toanimal = roads.distance(cell, start);
+            Distance const tohouse = roads.distance(cell, house);
+
+            if (toanimal != UNREACHABLE)
+                bound = std::max(bound, static_cast<unsigned>(toanimal) + roads.distance(start, house));
+
+            if (tohouse != UNREACHABLE)
+                bound = std::max(bound, static_cast<unsigned>(tohouse));
+        }
+    }
+
+    return bound;
+}
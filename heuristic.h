@@ -0,0 +1,32 @@
+#pragma once
+
+#include <limits>
+
+#include "board.h"
+
+class PatternDatabase;
+
+// Admissible and consistent lower bound of the moves left to solve a state:
+// the pet farthest from being delivered. A waiting pet needs the car to drive
+// to the animal and then to the house, a captured one just to the house.
+// With pattern databases, the larger of that and their bound.
+class Heuristic
+{
+public:
+
+    static constexpr unsigned INFINITE = std::numeric_limits<unsigned>::max();
+
+    explicit Heuristic(Board const& board, PatternDatabase const* patterns = nullptr)
+        : m_board(board)
+        , m_patterns(patterns)
+    {}
+
+    unsigned operator()(StateKey const& key) const;
+
+    // Largest value the road bound takes in any state, INFINITE with pattern databases
+    unsigned ceiling() const;
+
+private:
+    Board const& m_board;
+    PatternDatabase const* m_patterns;
+};
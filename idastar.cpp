@@ -0,0 +1,147 @@
+#include "solver.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "heuristic.h"
+
+namespace
+{
+
+// Lossy cache of the shallowest depth each state has been reached at during the current
+// iteration. Its size is fixed, so memory stays bounded whatever the depth of the search.
+// A state reached again no shallower than before has nothing new below it within the bound.
+class TranspositionTable
+{
+public:
+
+    static constexpr std::size_t SIZE = std::size_t(1) << 20;
+
+    TranspositionTable() : m_entries(SIZE) {}
+
+    void nextIteration() { ++m_iteration; }
+
+    // Returns true if the state needs to be searched from this depth
+    bool visit(StateKey const& key, StateHash hash, Distance depth)
+    {
+        auto& e = m_entries[hash & (SIZE - 1)];
+
+        if (e.iteration == m_iteration && e.key == key && e.depth <= depth)
+            return false;
+
+        e.key = key;
+        e.depth = depth;
+        e.iteration = m_iteration;
+
+        return true;
+    }
+
+private:
+
+    struct Entry
+    {
+        StateKey key;
+        Distance depth = 0;
+        std::uint32_t iteration = 0;
+    };
+
+    ArenaVector<Entry> m_entries;
+    std::uint32_t m_iteration = 0;
+};
+
+struct Frame
+{
+    StateKey key;
+    Successors succs;
+    SuccessorHashes hashes;
+    std::size_t next;
+};
+
+} // namespace
+
+StatePath solveIdaStar(BoardPtr const& board, StateKey const& inikey, PatternDatabase const* patterns, unsigned pruning)
+{
+    Heuristic const h(*board, patterns);
+    Pruning rules(*board, pruning);
+    TranspositionTable visited;
+    std::vector<Frame> path;
+    std::size_t expanded = 0;
+
+    // Frame of a state with its successors and their hashes
+    auto frame = [&](StateKey const& key, StateHash hash, StateKey const* from) {
+        Frame f{ key, {}, {}, 0 };
+        f.succs = board->adjacent(key, hash, f.hashes);
+
+        if (rules.enabled())
+            rules.apply(from, f.succs, &f.hashes);
+
+        return f;
+    };
+
+    if (State(*board, inikey).isFinal())
+        return { board, { inikey } };
+
+    for (unsigned bound = h(inikey); bound != Heuristic::INFINITE; )
+    {
+        unsigned nextbound = Heuristic::INFINITE;
+
+        StateHash const inihash = board->hash(inikey);
+
+        visited.nextIteration();
+        visited.visit(inikey, inihash, 0);
+
+        path.clear();
+        path.push_back(frame(inikey, inihash, nullptr));
+        ++expanded;
+
+        while (!path.empty())
+        {
+            auto& top = path.back();
+
+            if (top.next == top.succs.size())
+            {
+                path.pop_back();
+                continue;
+            }
+
+            StateKey const key = top.succs[top.next];
+            StateHash const hash = top.hashes[top.next++];
+            auto const depth = static_cast<Distance>(path.size());
+            auto const hv = h(key);
+
+            if (hv == Heuristic::INFINITE)
+                continue;
+
+            if (depth + hv > bound)
+            {
+                nextbound = std::min(nextbound, depth + hv);
+                continue;
+            }
+
+            if (!visited.visit(key, hash, depth))
+                continue;
+
+            State const state(*board, key);
+
+            if (state.isFinal())
+            {
+                stats::Reconstruction timer;
+                StatePath solpath{ board, {}, expanded, rules.counts() };
+
+                for (auto const& frame : path)
+                    solpath.keys.push_back(frame.key);
+
+                solpath.keys.push_back(key);
+
+                return solpath;
+            }
+
+            path.push_back(frame(key, hash, &path.back().key));
+            ++expanded;
+        }
+
+        bound = nextbound;
+    }
+
+    throw std::runtime_error("No solution");
+}
@@ -0,0 +1,197 @@
+#include "kernels.h"
+
+#include <array>
+
+#include "board.h"
+
+MoveMasks::MoveMasks(Board const& board)
+    : houseAt(board.numCells())
+    , startAt(board.numCells())
+{
+    auto const& codec = board.codec();
+
+    // Bits of one pet field alone in an empty key
+    auto bits = [&](std::size_t i, PetPos const& pet) {
+        StateKey key;
+        codec.setPet(key, i, pet);
+        return key;
+    };
+
+    for (std::size_t i = 0; i < codec.numPets(); ++i)
+    {
+        StateKey const capbit = bits(i, { 0, true });
+        StateKey const cellbits = bits(i, { INVALID_CELL, false });
+        StateKey const one = bits(i, { 1, false });
+        std::uint8_t const w = capbit.words[0] ? 0 : 1;
+
+        captured[w] |= capbit.words[w];
+        cellOnes[w] |= one.words[w];
+        spread = cellbits.words[w] / capbit.words[w];
+
+        houseAt[board.house(i)] = { w, capbit.words[w], capbit.words[w] | cellbits.words[w], 0 };
+
+        if (board.start(i) != board.house(i))
+            startAt[board.start(i)] = { w, capbit.words[w], capbit.words[w] | cellbits.words[w], bits(i, { board.start(i), false }).words[w] };
+    }
+}
+
+namespace
+{
+
+// One step of the car for all pets: the ones riding along take the new cell, the one whose house
+// it is gets dropped off, and a second successor picks up the animal waiting there if there is room.
+// The hash of every successor is the one of the key with the changes of its move.
+template<typename Push>
+inline void expandMasked(Board const& board, MoveMasks const& masks, StateKey const& key, StateHash hash, Push&& push)
+{
+    auto const& codec = board.codec();
+    auto const& zobrist = board.zobrist();
+    Cell const car = codec.car(key);
+
+    std::array<MoveMasks::Word, StateKey::NUM_WORDS> carried{};
+    std::array<MoveMasks::Word, StateKey::NUM_WORDS> fields{};
+    int num_captured = 0;
+
+    for (std::size_t w = 0; w < StateKey::NUM_WORDS; ++w)
+    {
+        carried[w] = key.words[w] & masks.captured[w];
+        fields[w] = carried[w] * masks.spread;
+        num_captured += __builtin_popcountll(carried[w]);
+    }
+
+    hash ^= zobrist.car(car);
+
+    for (Cell const newcar : board.roads().neighbors(car))
+    {
+        StateKey newkey = key;
+        StateHash newhash = hash ^ zobrist.car(newcar);
+        codec.setCar(newkey, newcar);
+
+        for (std::size_t w = 0; w < StateKey::NUM_WORDS; ++w)
+            newkey.words[w] = (newkey.words[w] & ~fields[w]) | ((newcar * masks.cellOnes[w]) & fields[w]);
+
+        auto const& house = masks.houseAt[newcar];
+        if (house.word != MoveMasks::NONE && (newkey.words[house.word] & house.captured))
+        {
+            newkey.words[house.word] &= ~house.captured;
+            newhash ^= zobrist.dropAt(newcar);
+        }
+
+        push(newkey, newhash);
+
+        auto const& start = masks.startAt[newcar];
+        if (num_captured < board.capacity() && start.word != MoveMasks::NONE
+                && (newkey.words[start.word] & start.field) == start.waiting)
+        {
+            newkey.words[start.word] |= start.captured;
+            push(newkey, newhash ^ zobrist.pickAt(newcar));
+        }
+    }
+}
+
+void expandBatch(Board const& board, MoveMasks const& masks, StateKey const* keys, std::size_t count,
+                 StateKey* out, std::uint32_t* offsets)
+{
+    std::uint32_t n = 0;
+    offsets[0] = 0;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        expandMasked(board, masks, keys[i], 0, [&](StateKey const& k, StateHash) { out[n++] = k; });
+        offsets[i + 1] = n;
+    }
+}
+
+void expandBatchHashed(Board const& board, MoveMasks const& masks, StateKey const* keys, StateHash const* hashes,
+                       std::size_t count, StateKey* out, StateHash* outhashes, std::uint32_t* offsets)
+{
+    std::uint32_t n = 0;
+    offsets[0] = 0;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        expandMasked(board, masks, keys[i], hashes[i], [&](StateKey const& k, StateHash h) {
+            out[n] = k;
+            outhashes[n++] = h;
+        });
+        offsets[i + 1] = n;
+    }
+}
+
+} // namespace
+
+Successors adjacentGeneric(Board const& board, StateKey const& key)
+{
+    auto const& codec = board.codec();
+    auto const numpets = codec.numPets();
+    Cell const car = codec.car(key);
+
+    Successors adjacent;
+
+    for (Cell const newcar : board.roads().neighbors(car))
+    {
+        StateKey newkey = key;
+        codec.setCar(newkey, newcar);
+
+        int num_captured = 0;
+        std::size_t icapt = numpets;
+        for (std::size_t i = 0; i < numpets; ++i) {
+            Cell const house = board.house(i);
+            PetPos pet = codec.pet(newkey, i);
+
+            num_captured += pet.captured ? 1 : 0;
+            pet.followCar(newcar, house, false);
+            codec.setPet(newkey, i, pet);
+
+            //check if car meets an animal
+            if (!pet.isHome(house) && !pet.captured && newcar == pet.animal)
+                icapt = i;
+        }
+
+        adjacent.push_back(newkey);
+
+        if (num_captured < board.capacity() && icapt != numpets)
+        {
+            PetPos pet = codec.pet(newkey, icapt);
+            pet.followCar(newcar, board.house(icapt), true);
+            codec.setPet(newkey, icapt, pet);
+            adjacent.push_back(newkey);
+        }
+    }
+
+    return adjacent;
+}
+
+Successors adjacentHashed(Board const& board, StateKey const& key, StateHash hash, SuccessorHashes& hashes)
+{
+    Successors adjacent;
+    hashes.clear();
+
+    expandMasked(board, board.moveMasks(), key, hash, [&](StateKey const& k, StateHash h) {
+        adjacent.push_back(k);
+        hashes.push_back(h);
+    });
+
+    return adjacent;
+}
+
+void adjacentBatch(Board const& board, StateKey const* keys, std::size_t count,
+                   std::vector<StateKey>& out, std::vector<std::uint32_t>& offsets,
+                   StateHash const* hashes, std::vector<StateHash>* outhashes)
+{
+    out.resize(count * MAX_SUCCESSORS);
+    offsets.resize(count + 1);
+
+    if (hashes && outhashes)
+    {
+        outhashes->resize(count * MAX_SUCCESSORS);
+        expandBatchHashed(board, board.moveMasks(), keys, hashes, count, out.data(), outhashes->data(), offsets.data());
+        outhashes->resize(offsets[count]);
+    }
+    else
+        expandBatch(board, board.moveMasks(), keys, count, out.data(), offsets.data());
+
+    out.resize(offsets[count]);
+
+    stats::generated(offsets[count]);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+
+#include <boost/container/static_vector.hpp>
+
+#include "statekey.h"
+
+class Board;
+
+// Four directions, each one may have a "pass by" and a "capture" move
+constexpr std::size_t MAX_SUCCESSORS = 8;
+
+using Successors = boost::container::static_vector<StateKey, MAX_SUCCESSORS>;
+
+// Hashes of successors, in the same order
+using SuccessorHashes = boost::container::static_vector<StateHash, MAX_SUCCESSORS>;
+
+// Successors of a key pet by pet; the masked kernels give exactly the same, in the same order
+Successors adjacentGeneric(Board const& board, StateKey const& key);
+
+// Masks over the pet fields of a key that let a move update every pet at once with a few
+// word-wide operations, whatever the number of pets
+struct MoveMasks
+{
+    using Word = StateKey::Word;
+
+    static constexpr std::uint8_t NONE = 0xff;
+
+    // The pet whose house or start a cell is
+    struct CellPet
+    {
+        std::uint8_t word = NONE;
+        Word captured = 0;      // its captured bit
+        Word field = 0;         // all bits of its field
+        Word waiting = 0;       // its field while it waits at the start
+    };
+
+    MoveMasks() = default;
+    explicit MoveMasks(Board const& board);
+
+    std::array<Word, StateKey::NUM_WORDS> captured{};    // captured bits of all pets
+    std::array<Word, StateKey::NUM_WORDS> cellOnes{};    // lowest bit of every cell field
+    Word spread = 0;                                    // a captured bit times this is the cell field of its pet
+    std::vector<CellPet> houseAt;
+    std::vector<CellPet> startAt;
+};
+
+// Successors of a key through the move masks along with their hashes, worked out from the
+// hash of the key by the changes of each move
+Successors adjacentHashed(Board const& board, StateKey const& key, StateHash hash, SuccessorHashes& hashes);
+
+// Successors of a chunk of keys in one pass over the move masks, the same keys in the same order
+// as adjacentGeneric(). The children of keys[i] are out[offsets[i]] ... out[offsets[i + 1] - 1].
+// Given the hashes of the keys, the hashes of the children go to outhashes the same way.
+// Portable code, every pet is updated at once by word-wide operations on the key.
+void adjacentBatch(Board const& board, StateKey const* keys, std::size_t count,
+                   std::vector<StateKey>& out, std::vector<std::uint32_t>& offsets,
+                   StateHash const* hashes = nullptr, std::vector<StateHash>* outhashes = nullptr);
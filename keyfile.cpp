@@ -0,0 +1,120 @@
+#include "keyfile.h"
+
+#include <stdexcept>
+
+namespace
+{
+
+constexpr std::size_t BUFFER_SIZE = 1 << 16;
+
+// Longest varint of a 128 bit difference
+constexpr std::size_t MAX_VARINT = 19;
+
+} // namespace
+
+KeyFileWriter::KeyFileWriter(std::string const& filename)
+    : m_filename(filename)
+    , m_ofs(filename, std::ios::binary | std::ios::trunc)
+{
+    if (!m_ofs)
+        throw std::runtime_error("Can't create " + filename);
+
+    m_buffer.reserve(BUFFER_SIZE);
+}
+
+KeyFileWriter::~KeyFileWriter()
+{
+    if (m_ofs.is_open())
+        flush();
+}
+
+void KeyFileWriter::write(StateKey const& key)
+{
+    auto lo = key.words[0] - m_last.words[0];
+    auto hi = key.words[1] - m_last.words[1] - (key.words[0] < m_last.words[0] ? 1 : 0);
+
+    if (m_buffer.size() + MAX_VARINT > BUFFER_SIZE)
+        flush();
+
+    while (hi != 0 || lo >= 0x80)
+    {
+        m_buffer.push_back(static_cast<char>((lo & 0x7f) | 0x80));
+        lo = (lo >> 7) | (hi << 57);
+        hi >>= 7;
+    }
+
+    m_buffer.push_back(static_cast<char>(lo));
+
+    m_last = key;
+    ++m_size;
+}
+
+void KeyFileWriter::close()
+{
+    flush();
+    m_ofs.close();
+
+    if (m_ofs.fail())
+        throw std::runtime_error("Can't write " + m_filename);
+}
+
+void KeyFileWriter::flush()
+{
+    m_ofs.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+    m_bytes += m_buffer.size();
+    m_buffer.clear();
+}
+
+KeyFileReader::KeyFileReader(std::string const& filename)
+    : m_ifs(filename, std::ios::binary)
+    , m_buffer(BUFFER_SIZE)
+{
+    if (!m_ifs)
+        throw std::runtime_error("Can't open " + filename);
+}
+
+bool KeyFileReader::next(StateKey& key)
+{
+    StateKey::Word lo = 0;
+    StateKey::Word hi = 0;
+
+    for (unsigned shift = 0; ; shift += 7)
+    {
+        if (m_pos == m_end && !fill())
+        {
+            if (shift != 0)
+                throw std::runtime_error("Truncated key file");
+            return false;
+        }
+
+        auto const byte = static_cast<StateKey::Word>(static_cast<unsigned char>(m_buffer[m_pos++]));
+        auto const bits = byte & 0x7f;
+
+        if (shift < 64)
+        {
+            lo |= bits << shift;
+            if (shift > 57)
+                hi |= bits >> (64 - shift);
+        }
+        else
+            hi |= bits << (shift - 64);
+
+        if ((byte & 0x80) == 0)
+            break;
+    }
+
+    key.words[0] = m_last.words[0] + lo;
+    key.words[1] = m_last.words[1] + hi + (key.words[0] < lo ? 1 : 0);
+    m_last = key;
+
+    return true;
+}
+
+bool KeyFileReader::fill()
+{
+    m_ifs.read(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+    m_pos = 0;
+    m_end = static_cast<std::size_t>(m_ifs.gcount());
+
+    return m_end != 0;
+}
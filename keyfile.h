@@ -0,0 +1,68 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "statekey.h"
+
+// Order of keys in key files: high word first
+inline bool keyLess(StateKey const& l, StateKey const& r)
+{
+    return l.words[1] != r.words[1] ? l.words[1] < r.words[1] : l.words[0] < r.words[0];
+}
+
+// File of strictly increasing state keys. Each one is stored as a varint of its difference
+// from the previous one, which takes a few bytes for the dense key sets of a search layer.
+class KeyFileWriter
+{
+public:
+
+    explicit KeyFileWriter(std::string const& filename);
+    ~KeyFileWriter();
+
+    KeyFileWriter(KeyFileWriter const&) = delete;
+    KeyFileWriter& operator=(KeyFileWriter const&) = delete;
+
+    // The key must come after the previous one
+    void write(StateKey const& key);
+
+    // Flushes everything, throws if anything could not be written
+    void close();
+
+    std::size_t size() const { return m_size; }
+    std::size_t bytes() const { return m_bytes; }
+
+private:
+
+    void flush();
+
+private:
+    std::string m_filename;
+    std::ofstream m_ofs;
+    std::vector<char> m_buffer;
+    StateKey m_last;
+    std::size_t m_size = 0;
+    std::size_t m_bytes = 0;
+};
+
+class KeyFileReader
+{
+public:
+
+    explicit KeyFileReader(std::string const& filename);
+
+    // False at the end of the file
+    bool next(StateKey& key);
+
+private:
+
+    bool fill();
+
+private:
+    std::ifstream m_ifs;
+    std::vector<char> m_buffer;
+    std::size_t m_pos = 0;
+    std::size_t m_end = 0;
+    StateKey m_last;
+};
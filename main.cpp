@@ -1,282 +1,489 @@
 #include <iostream>
-#include <fstream>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <limits>
 #include <map>
-#include <numeric>
-#include <queue>
-#include <future>
-
-#include <boost/operators.hpp>
-#include <boost/graph/breadth_first_search.hpp>
-#include <boost/graph/visitors.hpp>
-#include <boost/property_map/property_map.hpp>
-#include <boost/coroutine2/all.hpp>
-
-#include "readlines.h"
-#include "state.h"
-
-using StatePath = std::list<StatePtr>;
-using SolCoro = boost::coroutines2::coroutine<StatePtr>;
-
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "task.h"
+#include "puzzlereader.h"
+#include "workerpool.h"
+#include "output.h"
+
+// Puzzles parsed ahead of the solvers, per worker. Enough to pick the hardest ones first,
+// few enough not to hold a whole batch in memory.
+constexpr std::size_t QUEUED_PER_WORKER = 16;
+
+// A solution of a puzzle or its error. When several are asked for, they come one at a time
+// as they are found, and one without a path closes the puzzle.
 struct Solution
 {
     std::string filename;
     StatePath sol;
     std::exception_ptr error = nullptr;
+    std::size_t number = 1;         // among the solutions of the puzzle
+    bool last = true;               // no more of the puzzle follow
 };
 
-struct StateGraph {
-    using vertex_descriptor = StatePtr;
-    using edge_descriptor = std::pair<vertex_descriptor, vertex_descriptor>;
-    using directed_category = boost::undirected_tag;
-    using edge_parallel_category = boost::disallow_parallel_edge_tag;
-    using traversal_category = boost::incidence_graph_tag;
-    using out_edge_iterator = State::Iterator;
-    using degree_size_type = std::size_t;
+// How solutions are printed: every step as a grid, or one line of moves
+enum class Format
+{
+    Grid,
+    Compact
+};
 
-    static vertex_descriptor null_vertex()
-    {
-        return {};
-    }
+Format formatFromName(std::string const& name)
+{
+    if (name == "grid")
+        return Format::Grid;
+    if (name == "compact")
+        return Format::Compact;
+
+    throw std::invalid_argument("Unknown output format " + name);
+}
 
+// Order the solutions are printed in
+enum class Order
+{
+    Input,
+    Completion
+};
+
+struct Options
+{
+    SolverConfig config;
+    unsigned jobs = 0;
+    Order order = Order::Input;
+    Format format = Format::Grid;
+    std::string statsFile;      // JSON lines of solver statistics, "-" is stdout
+    std::size_t solutions = 1;  // more than one, or ALL_OPTIMAL, streams them from a breadth first search
+    std::vector<std::string> filenames;
 };
 
-struct Predecessors
+Order orderFromName(std::string const& name)
 {
-    using value_type = boost::graph_traits<StateGraph>::vertex_descriptor;
-    using reference = value_type&;
-    using key_type = boost::graph_traits<StateGraph>::vertex_descriptor;
-    using category = boost::writable_property_map_tag;
-    using data_type = std::map<key_type, value_type>;
+    if (name == "input")
+        return Order::Input;
+    if (name == "completion")
+        return Order::Completion;
 
-    friend void put(Predecessors& pmap, key_type k, value_type v)
+    throw std::invalid_argument("Unknown order " + name);
+}
+
+Options parseOptions(int argc, char* argv[])
+{
+    Options opts;
+
+    for (int i = 1; i < argc; ++i)
     {
-        (*pmap.data).insert({k, v});
+        std::string const arg = argv[i];
 
-        if (k->isFinal())
-            pmap.sink(k);
-    }
+        if (arg.compare(0, 2, "--") != 0)
+        {
+            opts.filenames.push_back(arg);
+            continue;
+        }
 
-    Predecessors(data_type* dptr, SolCoro::push_type& sink) : data(dptr), sink(sink) {}
+        auto const eq = arg.find('=');
+        auto const name = arg.substr(0, eq);
+        auto const value = eq == std::string::npos ? std::string() : arg.substr(eq + 1);
+
+        if (name == "--solver")
+            opts.config.solver = solverFromName(value);
+        else if (name == "--fast")
+            opts.config.solver = Solver::Greedy;
+        else if (name == "--no-bound")
+            opts.config.upperBound = false;
+        else if (name == "--threads")
+            opts.config.threads = static_cast<unsigned>(std::stoul(value));
+        else if (name == "--pdb")
+            opts.config.patterns = true;
+        else if (name == "--pdb-dir")
+        {
+            opts.config.patterns = true;
+            opts.config.patternDir = value;
+        }
+        else if (name == "--prune")
+            opts.config.pruning = pruneRulesFromNames(value);
+        else if (name == "--cache")
+            opts.config.cache = std::make_shared<SolutionCache>(std::stoul(value) << 20);
+        else if (name == "--memory")
+        {
+            opts.config.solver = Solver::ExternalBFS;
+            opts.config.memory = std::stoul(value) << 20;
+        }
+        else if (name == "--tmp-dir")
+            opts.config.tempDir = value;
+        else if (name == "--checkpoint")
+            opts.config.checkpoint.dir = value;
+        else if (name == "--checkpoint-interval")
+            opts.config.checkpoint.interval = std::stod(value);
+        else if (name == "--resume")
+            opts.config.checkpoint.resume = true;
+        else if (name == "--jobs")
+            opts.jobs = static_cast<unsigned>(std::stoul(value));
+        else if (name == "--order")
+            opts.order = orderFromName(value);
+        else if (name == "--output")
+            opts.format = formatFromName(value);
+        else if (name == "--stats")
+            opts.statsFile = value;
+        else if (name == "--solutions")
+            opts.solutions = value == "optimal" ? ALL_OPTIMAL : std::stoul(value);
+        else
+            throw std::invalid_argument("Unknown option " + arg);
+    }
 
-private:
-    data_type* data;
-    SolCoro::push_type& sink;
-};
+    if (opts.config.checkpoint.resume && opts.config.checkpoint.dir.empty())
+        throw std::invalid_argument("--resume needs --checkpoint=DIR");
 
+    return opts;
+}
 
-struct Queue
+// Solutions handed over by the workers, taken by the printing thread
+class Results
 {
-    using value_type = 	boost::graph_traits<StateGraph>::vertex_descriptor;
-    using size_type = std::size_t;
+public:
 
-    void push(const value_type& t)	{ data.push(t); }
-    void pop() { data.pop(); }
-    value_type& top() { return data.front(); }
-    const value_type& top() const { return data.front(); }
-    size_type size() const { return data.size(); }
-    bool empty() const { return data.empty(); }
+    explicit Results(Order order) : m_order(order) {}
 
-private:
-    std::queue<value_type> data;
-};
+    void put(std::size_t index, Solution&& sol)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_solutions[index].push_back(std::move(sol));
 
-struct Colors
-{
-    using value_type = boost::default_color_type;
-    using reference = value_type&;
-    using key_type = boost::graph_traits<StateGraph>::vertex_descriptor;
-    using category = boost::read_write_property_map_tag;
-    using data_type = std::map<key_type, value_type>;
+            if (m_order == Order::Completion)
+                m_arrived.push_back(index);
+        }
 
-    friend void put(Colors& pmap, key_type k, value_type v)
+        m_ready.notify_one();
+    }
+
+    // No more than count puzzles are going to be put
+    void close(std::size_t count)
     {
-        (*pmap.data)[k] = v;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_count = count;
+        }
+
+        m_ready.notify_one();
     }
 
-    friend value_type get(Colors& pmap, key_type k)
+    // Whether take() returns right away
+    bool ready()
     {
-        auto [it, ok] = pmap.data->insert({k, value_type::white_color});
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return available();
+    }
 
-        return it->second;
+    // Blocks until the next solution is there, empty once all have been taken
+    std::optional<Solution> take()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_ready.wait(lock, [this]() { return available(); });
+
+        std::size_t const index = m_order == Order::Input ? m_taken : m_arrived.empty() ? m_count : m_arrived.front();
+
+        if (m_taken == m_count)
+            return std::nullopt;
+
+        auto const it = m_solutions.find(index);
+        Solution sol = std::move(it->second.front());
+        it->second.pop_front();
+
+        if (it->second.empty())
+            m_solutions.erase(it);
+
+        if (m_order == Order::Completion)
+            m_arrived.pop_front();
+
+        if (sol.last)
+            ++m_taken;
+
+        return sol;
     }
 
-    Colors(data_type* dptr) : data(dptr) {}
+private:
+
+    bool available() const
+    {
+        if (m_taken == m_count)
+            return true;
+
+        return m_order == Order::Input ? m_solutions.count(m_taken) != 0 : !m_arrived.empty();
+    }
 
 private:
-    data_type* data;
+    Order const m_order;
+    std::mutex m_mutex;
+    std::condition_variable m_ready;
+    std::map<std::size_t, std::deque<Solution>> m_solutions;    // put and not taken yet, by puzzle
+    std::deque<std::size_t> m_arrived;              // puzzles of the solutions in the order they were put, completion order only
+    std::size_t m_taken = 0;                        // puzzles whose last solution has been taken
+    std::size_t m_count = std::numeric_limits<std::size_t>::max();
 };
 
-
-boost::graph_traits<StateGraph>::vertex_descriptor
-source(boost::graph_traits<StateGraph>::edge_descriptor e, StateGraph const& /*g*/)
+void printError(BufferedWriter& out, std::exception_ptr error)
 {
-    return e.first;
+    try {
+        std::rethrow_exception(error);
+    } catch (std::exception& e) {
+        out.flush();
+        std::cerr << "Error: " << e.what() << std::endl;
+    }
 }
 
-boost::graph_traits<StateGraph>::vertex_descriptor
-target(boost::graph_traits<StateGraph>::edge_descriptor e, StateGraph const& /*g*/)
+void printPath(BufferedWriter& out, StatePath const& path)
 {
-    return e.second;
-}
+    GridRenderer grid(*path.board);
 
-std::pair<boost::graph_traits<StateGraph>::out_edge_iterator, boost::graph_traits<StateGraph>::out_edge_iterator>
-out_edges(boost::graph_traits<StateGraph>::vertex_descriptor v, StateGraph const& /*g*/)
-{
-    return v->outEdges();
+    for (std::size_t i = 0; i < path.keys.size(); ++i)
+    {
+        out << "step #" << i << '\n';
+        grid.render(path.keys[i], out);
+        out << '\n';
+    }
 }
 
-boost::graph_traits<StateGraph>::degree_size_type
-out_degree(boost::graph_traits<StateGraph>::vertex_descriptor v, StateGraph const& /*g*/)
+// One line per solution: the moves, how many, and what it took to find them
+void printCompact(BufferedWriter& out, std::string const& name, char const* what, StatePath const& path)
 {
-    return v->outDegree();
+    out << std::string_view(name) << ": " << what << ' ' << path.keys.size() - 1 << ": "
+        << std::string_view(moveString(*path.board, path.keys))
+        << "; expanded " << path.expanded << ", generated " << path.stats.generated << ", ";
+    out.fixed(path.stats.searchSeconds * 1e3, 3) << " ms\n";
 }
 
-class Task
+void printSolution(BufferedWriter& out, Solution const& sol, Format format)
 {
-public:
+    // Closes a puzzle whose solutions have all been printed
+    if (!sol.error && sol.sol.keys.empty())
+        return;
 
+    std::string const what = sol.number == 1 ? "solved in" : "solution #" + std::to_string(sol.number) + " in";
 
-    Task(std::string const& filename)
-        : m_streets(std::make_shared<Streets>())
+    if (format == Format::Compact)
     {
-        std::ifstream ifs(filename);
-
-        if (!ifs)
-            throw std::runtime_error("Can't open file " + filename);
-
-        std::map<char, Pet::Builder> pet_builders;
-        std::string::size_type line_size = 0;
-
-        auto lines = readLines(ifs);
+        if (sol.error)
+            return printError(out, sol.error);
 
-        for (decltype(lines)::size_type row = 0, numrows = lines.size(); row < numrows; ++row )
-        {
-            auto const& line = lines[row];
-
-            if (line_size == 0)
-                line_size = line.size();
-            else if (line_size != line.size())
-                throw std::runtime_error("Lines of different lengths in input file");
-
-            std::vector<char> street;
-
-            for (std::string::size_type col = 0; col < line_size; ++col)
-            {
-                auto c = line[col];
-
-                if (isAnimalOrHouse(c))
-                {
-                    auto& pb = pet_builders[Pet::asAnimalName(c)];
+        return printCompact(out, sol.filename, what.c_str(), sol.sol);
+    }
 
-                    pb.addPos(c, { row, col });
+    out << "--- " << std::string_view(sol.filename);
+    if (sol.number != 1)
+        out << " solution #" << sol.number;
+    out << " ---\n";
 
-                    street.push_back(ROAD);
-                }
-                else if (c == CAR)
-                {
-                    m_car = {row, col};
-                    street.push_back(ROAD);
-                }
-                else if (c != ROAD && c != WAY && c != NOWAY)
-                    throw std::runtime_error("Bad char in input file");
-                else
-                    street.push_back(c);
-            }
+    if (sol.error)
+        return printError(out, sol.error);
 
-            m_streets->push_back(std::move(street));
-        }
+    printPath(out, sol.sol);
+    out << std::string_view(sol.filename) << ": " << std::string_view(what) << ' ' << sol.sol.keys.size() - 1 << "\n\n";
+}
 
-        m_pets.reserve(pet_builders.size());
+void printJsonString(BufferedWriter& out, std::string_view s)
+{
+    static char const hex[] = "0123456789abcdef";
 
-        std::for_each(pet_builders.begin(), pet_builders.end(), [this](auto& pb) {
-            m_pets.push_back(pb.second.build());
-        });
+    out << '"';
 
-        if (m_car == INVALID_POSITION)
-            throw std::runtime_error("No car position specified.");
+    for (char const c : s)
+    {
+        auto const u = static_cast<unsigned char>(c);
+
+        if (c == '"' || c == '\\')
+            out << '\\' << c;
+        else if (u < 0x20)
+            out << "\\u00" << hex[u >> 4] << hex[u & 0xf];
+        else
+            out << c;
     }
 
-    StatePath Solve() const
-    {
-        StatePath solpath;
+    out << '"';
+}
 
-        StateGraph g;
-        StateRegistryPtr statereg = std::make_shared<StateRegistry>();
-        StatePtr inistate = State::addState(statereg, m_streets, std::make_tuple(m_pets, m_car));
-        Queue buf;
-        Predecessors::data_type preds;
-        Colors::data_type colors;
+// One JSON object per line and solution
+void printStats(BufferedWriter& out, Solution const& sol, Solver solver)
+{
+    if (!sol.error && sol.sol.keys.empty())
+        return;
+
+    out << "{\"name\":";
+    printJsonString(out, sol.filename);
+    out << ",\"solver\":\"" << solverName(solver) << '"';
+
+    if (sol.number != 1)
+        out << ",\"solution\":" << sol.number;
+
+    try {
+        if (sol.error)
+            std::rethrow_exception(sol.error);
+    } catch (std::exception& e) {
+        out << ",\"error\":";
+        printJsonString(out, e.what());
+        out << "}\n";
+        return;
+    }
 
-        SolCoro::pull_type solcoro([&](SolCoro::push_type& sink){
-            boost::breadth_first_visit(g,
-                                       inistate,
-                                       buf,
-                                       boost::make_bfs_visitor(boost::record_predecessors(Predecessors(&preds, sink),
-                                                                                          boost::on_tree_edge())),
-                                       Colors(&colors));
+    auto const& st = sol.sol.stats;
 
-        });
+    out << ",\"length\":" << sol.sol.keys.size() - 1
+        << ",\"expanded\":" << sol.sol.expanded
+        << ",\"generated\":" << st.generated
+        << ",\"duplicates\":" << st.duplicates
+        << ",\"peak_states\":" << st.peakStates
+        << ",\"allocated_bytes\":" << st.allocated
+        << ",\"parse_ms\":";
+    out.fixed(st.parseSeconds * 1e3, 3) << ",\"search_ms\":";
+    out.fixed(st.searchSeconds * 1e3, 3) << ",\"reconstruct_ms\":";
+    out.fixed(st.reconstructSeconds * 1e3, 3);
 
-        for (StatePtr s = solcoro.get(); s != inistate; s = preds[s])
-            solpath.push_front(s);
+    if (st.checkpoints || st.resumedStates)
+    {
+        out << ",\"checkpoints\":" << st.checkpoints
+            << ",\"checkpoint_bytes\":" << st.checkpointBytes
+            << ",\"checkpoint_ms\":";
+        out.fixed(st.checkpointSeconds * 1e3, 3) << ",\"checkpoint_write_ms\":";
+        out.fixed(st.checkpointWriteSeconds * 1e3, 3) << ",\"resumed_states\":" << st.resumedStates;
+    }
 
-        solpath.push_front(inistate);
+    out << ",\"frontier\":[";
 
-        return solpath;
-    }
+    for (std::size_t i = 0; i < st.frontier.size(); ++i)
+        out << (i ? "," : "") << st.frontier[i];
 
-private:
-    StreetsPtr m_streets;
-    Pets m_pets;
-    Position m_car = INVALID_POSITION;
-};
+    out << "]}\n";
+}
 
 #ifndef TEST
 
 int main(int argc, char* argv[])
 {
-    if (argc < 2)
+    Options opts;
+
+    try {
+        opts = parseOptions(argc, argv);
+    } catch (std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (opts.filenames.empty())
     {
-        std::cout << "Usasge: " << argv[0] << " <task_filename> [...]" << std::endl;
+        std::cout << "Usage: " << argv[0] << " [--solver=bfs|astar|idastar|bidir|pbfs|ebfs|greedy] [--fast] [--no-bound] [--threads=N] [--pdb] [--pdb-dir=DIR] [--prune=all|none|capture,noreturn] [--cache=MB] [--memory=MB] [--tmp-dir=DIR] [--checkpoint=DIR] [--checkpoint-interval=SECONDS] [--resume] [--jobs=N] [--order=input|completion] [--output=grid|compact] [--stats=FILE|-] [--solutions=N|optimal] <batch_filename|-> [...]" << std::endl;
         return EXIT_SUCCESS;
     }
 
-    std::vector<std::future<Solution>> futures(static_cast<std::size_t>(argc - 1));
+    BufferedWriter out(stdout);
+    std::unique_ptr<std::FILE, int (*)(std::FILE*)> statsfile(nullptr, &std::fclose);
+    std::unique_ptr<BufferedWriter> statswriter;
+    BufferedWriter* statsout = nullptr;
 
-    for (std::size_t i = 1; i < static_cast<std::size_t>(argc); ++i)
+    if (opts.statsFile == "-")
+        statsout = &out;
+    else if (!opts.statsFile.empty())
     {
-        futures[i - 1] = std::async(std::launch::async, [filename = argv[i]](){
-            try {
-                Task task(filename);
-                return Solution{ filename, task.Solve() };
-            } catch (...) {
-                return Solution{filename, {}, std::current_exception() };
-            }
-        });
+        statsfile.reset(std::fopen(opts.statsFile.c_str(), "w"));
+
+        if (!statsfile)
+        {
+            std::cerr << "Error: Can't create " << opts.statsFile << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        statswriter = std::make_unique<BufferedWriter>(statsfile.get());
+        statsout = statswriter.get();
     }
 
+    Results results(opts.order);
+    WorkerPool pool(opts.jobs);
 
-    for (auto& ftr : futures)
-    {
-        Solution sol = ftr.get();
+    // Several solutions always come from a breadth first search
+    Solver const solver = opts.solutions == 1 ? opts.config.solver : Solver::BFS;
 
-        std::cout << "--- " << sol.filename << " ---" << std::endl;
+    std::thread printer([&results, &out, statsout, solver, format = opts.format]() {
+        while (auto sol = results.take())
+        {
+            printSolution(out, *sol, format);
 
-        try {
-            if (sol.error)
-                std::rethrow_exception(sol.error);
-        } catch (std::exception& e) {
-            std::cerr << "Error: " << e.what() << std::endl;
-            continue;
+            if (statsout)
+                printStats(*statsout, *sol, solver);
+
+            // Whatever is printed shows before the printer waits for more
+            if (!results.ready())
+            {
+                out.flush();
+
+                if (statsout)
+                    statsout->flush();
+            }
         }
 
-        int i = 0;
-        for (auto const& step : sol.sol)
-            std::cout << "step #" << i++ << '\n' << *step << std::endl;
+        out.flush();
+
+        if (statsout)
+            statsout->flush();
+    });
+
+    std::size_t count = 0;
+
+    // Puzzles are parsed as they are read and queued by difficulty, a bounded number at a time
+    for (auto const& filename : opts.filenames)
+    {
+        try {
+            PuzzleReader reader(filename);
+            PuzzleText puzzle;
+
+            while (reader.next(puzzle))
+            {
+                std::size_t const i = count++;
+
+                try {
+                    Task task(puzzle.text);
+
+                    pool.submit([&results, i, name = puzzle.name, task, config = opts.config, count = opts.solutions]() {
+                        try {
+                            if (count == 1)
+                                results.put(i, Solution{ name, task.Solve(config), nullptr, 1, true });
+                            else
+                            {
+                                // Every solution goes to the printer as soon as it is found
+                                std::size_t number = 0;
+
+                                task.Stream(count, [&results, &name, i, &number](StatePath&& path) {
+                                    results.put(i, Solution{ name, std::move(path), nullptr, ++number, false });
+                                    return true;
+                                });
+
+                                results.put(i, Solution{ name, {}, nullptr, number + 1, true });
+                            }
+                        } catch (...) {
+                            results.put(i, Solution{ name, {}, std::current_exception(), 1, true });
+                        }
+                    }, task.difficulty());
+                } catch (...) {
+                    results.put(i, Solution{ puzzle.name, {}, std::current_exception(), 1, true });
+                }
 
-        std::cout << sol.filename << ": solved in " << i - 1 << '\n' << std::endl;
+                pool.wait(QUEUED_PER_WORKER * pool.size());
+            }
+        } catch (...) {
+            results.put(count++, Solution{ filename, {}, std::current_exception(), 1, true });
+        }
     }
 
+    results.close(count);
+    printer.join();
+
     return EXIT_SUCCESS;
 }
 
@@ -0,0 +1,117 @@
+#include "output.h"
+
+BufferedWriter::BufferedWriter(std::FILE* file, std::size_t capacity)
+    : m_file(file)
+    , m_capacity(capacity)
+{
+    m_buffer.reserve(capacity);
+}
+
+BufferedWriter::~BufferedWriter()
+{
+    flush();
+}
+
+BufferedWriter& BufferedWriter::operator<<(std::string_view s)
+{
+    if (m_buffer.size() + s.size() > m_capacity)
+        flush();
+
+    if (s.size() >= m_capacity)
+        std::fwrite(s.data(), 1, s.size(), m_file);
+    else
+        m_buffer.append(s);
+
+    return *this;
+}
+
+BufferedWriter& BufferedWriter::fixed(double value, int decimals)
+{
+    char digits[32];
+    int const n = std::snprintf(digits, sizeof(digits), "%.*f", decimals, value);
+    return *this << std::string_view(digits, static_cast<std::size_t>(n));
+}
+
+void BufferedWriter::flush()
+{
+    std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file);
+    std::fflush(m_file);
+    m_buffer.clear();
+}
+
+std::string moveString(Board const& board, std::vector<StateKey> const& keys)
+{
+    auto const& codec = board.codec();
+    std::string moves;
+
+    for (std::size_t i = 1; i < keys.size(); ++i)
+    {
+        Position const from = board.positionOf(codec.car(keys[i - 1]));
+        Position const to = board.positionOf(codec.car(keys[i]));
+
+        if (to.first != from.first)
+            moves.push_back(to.first < from.first ? 'U' : 'D');
+        else
+            moves.push_back(to.second < from.second ? 'L' : 'R');
+
+        for (std::size_t p = 0, numpets = codec.numPets(); p < numpets; ++p)
+        {
+            if (!codec.pet(keys[i - 1], p).captured && codec.pet(keys[i], p).captured)
+                moves.push_back(board.pets()[p].animalName());
+        }
+    }
+
+    return moves;
+}
+
+GridRenderer::GridRenderer(Board const& board)
+    : m_board(board)
+    , m_offsets(board.numCells())
+{
+    auto const& streets = board.streets();
+    auto const width = static_cast<std::size_t>(streets.width());
+
+    for (int row = 0; row < streets.height(); ++row)
+    {
+        m_streets.append(streets.row(row), width);
+        m_streets.push_back('\n');
+    }
+
+    auto offsetOf = [width](Position const& pos) {
+        return static_cast<std::size_t>(pos.first) * (width + 1) + static_cast<std::size_t>(pos.second);
+    };
+
+    for (Cell cell = 0; cell < board.numCells(); ++cell)
+        m_offsets[cell] = offsetOf(board.positionOf(cell));
+
+    for (auto const& pet : board.pets())
+        m_streets[offsetOf(pet.housePosition())] = pet.houseName();
+}
+
+void GridRenderer::render(StateKey const& key, BufferedWriter& out)
+{
+    auto const& codec = m_board.codec();
+    auto const& pets = m_board.pets();
+
+    m_grid = m_streets;
+
+    for (std::size_t i = 0; i < pets.size(); ++i)
+    {
+        PetPos const pet = codec.pet(key, i);
+
+        if (!pet.captured && !pet.isHome(m_board.house(i)))
+            m_grid[m_offsets[pet.animal]] = pets[i].animalName();
+    }
+
+    m_grid[m_offsets[codec.car(key)]] = CAR;
+
+    out << std::string_view(m_grid) << "Captured: ";
+
+    for (std::size_t i = 0; i < pets.size(); ++i)
+    {
+        if (codec.pet(key, i).captured)
+            out << pets[i].animalName() << ' ';
+    }
+
+    out << '\n';
+}
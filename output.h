@@ -0,0 +1,72 @@
+#pragma once
+
+#include <charconv>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "board.h"
+
+// Output through one large buffer, written out when it fills up and on flush().
+// Nothing is flushed line by line.
+class BufferedWriter
+{
+public:
+
+    explicit BufferedWriter(std::FILE* file, std::size_t capacity = std::size_t(1) << 16);
+    ~BufferedWriter();
+
+    BufferedWriter(BufferedWriter const&) = delete;
+    BufferedWriter& operator=(BufferedWriter const&) = delete;
+
+    BufferedWriter& operator<<(char c)
+    {
+        if (m_buffer.size() == m_capacity)
+            flush();
+
+        m_buffer.push_back(c);
+        return *this;
+    }
+
+    BufferedWriter& operator<<(std::string_view s);
+
+    template<typename Int, typename = std::enable_if_t<std::is_integral_v<Int>>>
+    BufferedWriter& operator<<(Int value)
+    {
+        char digits[24];
+        auto const end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+        return *this << std::string_view(digits, static_cast<std::size_t>(end - digits));
+    }
+
+    // Number with that many decimals
+    BufferedWriter& fixed(double value, int decimals);
+
+    void flush();
+
+private:
+    std::FILE* m_file;
+    std::size_t const m_capacity;
+    std::string m_buffer;
+};
+
+// One of U, D, L, R per car move, followed by the name of the animal picked up there if any
+std::string moveString(Board const& board, std::vector<StateKey> const& keys);
+
+// Draws states as the grid of their puzzle: the streets with the houses are laid out once,
+// each drawing copies them and puts the waiting animals and the car at their precomputed places
+class GridRenderer
+{
+public:
+
+    explicit GridRenderer(Board const& board);
+
+    void render(StateKey const& key, BufferedWriter& out);
+
+private:
+    Board const& m_board;
+    std::string m_streets;              // rows ended by '\n', houses included
+    std::vector<std::size_t> m_offsets; // per cell, its place in m_streets
+    std::string m_grid;                 // scratch copy drawn on
+};
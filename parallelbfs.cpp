@@ -0,0 +1,204 @@
+#include "solver.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+
+constexpr unsigned SHARD_BITS = 6;
+constexpr std::size_t NUM_SHARDS = std::size_t(1) << SHARD_BITS;
+
+// States handed to a worker at a time
+constexpr std::size_t CHUNK_SIZE = 256;
+
+// State set shared by all workers: the keys are spread over independently locked
+// registries by the high bits of their hash, the registry of the shard probes with the low ones.
+// A StateId keeps the shard in its low bits.
+class ConcurrentStateSet
+{
+public:
+
+    // Returns the id of the key and whether it has just been added, with pred as its predecessor
+    std::pair<StateId, bool> insert(StateKey const& key, StateHash hash, StateId pred)
+    {
+        auto const shardno = static_cast<StateId>(hash >> (64 - SHARD_BITS));
+        auto& shard = m_shards[shardno];
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto const [local, inserted] = shard.registry.insert(key, hash);
+
+        if (local >= (StateId(1) << (32 - SHARD_BITS)) - 1)
+            throw std::runtime_error("Too many states");
+
+        if (inserted)
+            shard.preds.push_back(pred);
+
+        return { (local << SHARD_BITS) | shardno, inserted };
+    }
+
+    // Not synchronized, for use once the workers are done
+    StateKey const& key(StateId id) const { return shard(id).registry.key(id >> SHARD_BITS); }
+    StateId pred(StateId id) const { return shard(id).preds[id >> SHARD_BITS]; }
+
+private:
+
+    struct alignas(64) Shard
+    {
+        std::mutex mutex;
+        StateRegistry registry;
+        std::vector<StateId> preds;
+    };
+
+    Shard const& shard(StateId id) const { return m_shards[id & (NUM_SHARDS - 1)]; }
+
+private:
+    std::array<Shard, NUM_SHARDS> m_shards;
+};
+
+// Frontier entries carry their key and its hash, so workers never read the set while others write it
+struct Node
+{
+    StateId id;
+    StateKey key;
+    StateHash hash;
+};
+
+} // namespace
+
+StatePath solveParallelBfs(BoardPtr const& board, StateKey const& inikey, unsigned threads)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    if (State(*board, inikey).isFinal())
+        return { board, { inikey } };
+
+    // The shards grow from every worker thread, so they can't take from the arena of this one
+    ArenaScope heap(ArenaScope::Detached);
+    ConcurrentStateSet states;
+    std::vector<Node> frontier;
+    std::vector<std::vector<Node>> buffers(threads);
+    std::atomic<std::size_t> expanded{ 0 };
+    std::size_t numstates = 1;
+    std::atomic<StateId> found{ INVALID_STATE };
+
+    StateHash const inihash = board->hash(inikey);
+    StateId const inistate = states.insert(inikey, inihash, INVALID_STATE).first;
+    frontier.push_back({ inistate, inikey, inihash });
+
+    while (!frontier.empty() && found == INVALID_STATE)
+    {
+        stats::frontier(frontier.size());
+
+        std::atomic<std::size_t> nextchunk{ 0 };
+
+        auto work = [&](std::vector<Node>& out) {
+            std::size_t count = 0;
+            std::vector<StateKey> keys;
+            std::vector<StateHash> hashes;
+            std::vector<StateKey> succs;
+            std::vector<StateHash> succhashes;
+            std::vector<std::uint32_t> offsets;
+
+            for (;;)
+            {
+                auto const begin = nextchunk.fetch_add(CHUNK_SIZE);
+
+                if (begin >= frontier.size())
+                    break;
+
+                auto const end = std::min(begin + CHUNK_SIZE, frontier.size());
+
+                keys.clear();
+                hashes.clear();
+                for (auto i = begin; i < end; ++i)
+                {
+                    keys.push_back(frontier[i].key);
+                    hashes.push_back(frontier[i].hash);
+                }
+
+                adjacentBatch(*board, keys.data(), keys.size(), succs, offsets, hashes.data(), &succhashes);
+
+                for (auto i = begin; i < end; ++i, ++count)
+                {
+                    for (auto k = offsets[i - begin]; k < offsets[i - begin + 1]; ++k)
+                    {
+                        StateKey const& key = succs[k];
+                        auto const [id, inserted] = states.insert(key, succhashes[k], frontier[i].id);
+
+                        if (!inserted)
+                            continue;
+
+                        out.push_back({ id, key, succhashes[k] });
+
+                        if (State(*board, key).isFinal())
+                        {
+                            StateId none = INVALID_STATE;
+                            found.compare_exchange_strong(none, id);
+                        }
+                    }
+                }
+            }
+
+            expanded += count;
+        };
+
+        // The level barrier is joining the workers, the calling thread is one of them
+        std::vector<std::thread> workers;
+        std::vector<stats::Counters> counts(threads);
+        workers.reserve(threads - 1);
+
+        for (unsigned t = 1; t < threads; ++t)
+        {
+            workers.emplace_back([&, t]() {
+                auto const start = stats::counters;
+                work(buffers[t]);
+                counts[t] = stats::since(start);
+            });
+        }
+
+        work(buffers[0]);
+
+        for (auto& w : workers)
+            w.join();
+
+        for (unsigned t = 1; t < threads; ++t)
+            stats::add(counts[t]);
+
+        std::size_t total = 0;
+        for (auto const& buf : buffers)
+            total += buf.size();
+
+        numstates += total;
+        stats::states(numstates);
+
+        frontier.clear();
+        frontier.reserve(total);
+
+        for (auto& buf : buffers)
+        {
+            frontier.insert(frontier.end(), buf.begin(), buf.end());
+            buf.clear();
+        }
+    }
+
+    if (found == INVALID_STATE)
+        throw std::runtime_error("No solution");
+
+    // Every final state found at this level is equally short, any of them will do
+    stats::Reconstruction timer;
+    StatePath solpath{ board, {}, expanded };
+
+    for (StateId s = found; s != INVALID_STATE; s = states.pred(s))
+        solpath.keys.push_back(states.key(s));
+
+    std::reverse(solpath.keys.begin(), solpath.keys.end());
+
+    return solpath;
+}
@@ -0,0 +1,272 @@
+#include "patterndb.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+#include <boost/container_hash/hash.hpp>
+
+#include "state.h"
+#include "heuristic.h"
+
+namespace
+{
+
+constexpr std::uint32_t FILE_MAGIC = 0x31424450;   // "PDB1"
+constexpr std::size_t MAX_PETS = 64;
+
+// Where a pet stands as far as the tables are concerned
+unsigned petCode(PetPos const& pet, Cell house)
+{
+    return pet.captured ? 1 : pet.isHome(house) ? 2 : 0;
+}
+
+std::size_t binomial(std::size_t n, std::size_t k)
+{
+    std::size_t result = 1;
+    for (std::size_t i = 1; i <= k; ++i)
+        result = result * (n - k + i) / i;
+
+    return result;
+}
+
+template<typename T>
+void writeValue(std::ostream& os, T const& value)
+{
+    os.write(reinterpret_cast<char const*>(&value), sizeof(value));
+}
+
+template<typename T>
+bool readValue(std::istream& is, T& value)
+{
+    return static_cast<bool>(is.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+} // namespace
+
+PatternDatabase::PatternDatabase(Board const& board, unsigned threads)
+    : m_board(&board)
+{
+    auto const numpets = board.pets().size();
+
+    if (numpets > MAX_PETS)
+        throw std::runtime_error("Too many pets for pattern databases");
+
+    m_subsetsize = std::min(MAX_SUBSET, numpets);
+    m_tablesize = board.numCells();
+
+    for (std::size_t i = 0; i < m_subsetsize; ++i)
+        m_tablesize *= 3;
+
+    // All combinations of m_subsetsize pets in lexicographic order
+    Subset subset{};
+    for (std::size_t i = 0; i < m_subsetsize; ++i)
+        subset[i] = static_cast<std::uint8_t>(i);
+
+    while (m_subsetsize > 0 && m_subsets.size() < binomial(numpets, m_subsetsize))
+    {
+        m_subsets.push_back(subset);
+
+        std::size_t i = m_subsetsize;
+        while (subset[i - 1] == numpets - m_subsetsize + i - 1)
+            --i;
+
+        ++subset[i - 1];
+        for (std::size_t j = i; j < m_subsetsize; ++j)
+            subset[j] = static_cast<std::uint8_t>(subset[j - 1] + 1);
+    }
+
+    m_distances.assign(m_subsets.size() * m_tablesize, UNSOLVABLE);
+
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    threads = static_cast<unsigned>(std::min<std::size_t>(threads, m_subsets.size()));
+
+    std::atomic<std::size_t> next{ 0 };
+    std::vector<std::thread> workers;
+
+    for (unsigned t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([this, &next]() {
+            for (std::size_t i; (i = next++) < m_subsets.size(); )
+                buildSubset(i);
+        });
+    }
+
+    for (auto& w : workers)
+        w.join();
+}
+
+// Breadth first search backwards from the delivered states of a board with the subset's pets only
+void PatternDatabase::buildSubset(std::size_t isubset)
+{
+    Pets pets;
+    for (std::size_t i = 0; i < m_subsetsize; ++i)
+        pets.push_back(m_board->pets()[m_subsets[isubset][i]]);
+
+    Board const sub(Streets(m_board->streets()), std::move(pets), m_board->capacity());
+    auto const& codec = sub.codec();
+    auto* const dist = &m_distances[isubset * m_tablesize];
+
+    auto indexOf = [&](StateKey const& key) {
+        std::size_t code = 0;
+        for (std::size_t i = m_subsetsize; i-- > 0; )
+            code = code * 3 + petCode(codec.pet(key, i), sub.house(i));
+
+        return codec.car(key) + sub.numCells() * code;
+    };
+
+    // The subset is delivered whatever the car does afterwards, so every car cell is a goal
+    StateKey delivered = sub.finalKeys().front();
+    std::vector<StateKey> queue;
+
+    for (std::size_t car = 0; car < sub.numCells(); ++car)
+    {
+        codec.setCar(delivered, static_cast<Cell>(car));
+        dist[indexOf(delivered)] = 0;
+        queue.push_back(delivered);
+    }
+
+    for (std::size_t head = 0; head < queue.size(); ++head)
+    {
+        auto const key = queue[head];
+        auto const depth = static_cast<std::uint8_t>(std::min(dist[indexOf(key)] + 1, UNSOLVABLE - 1));
+
+        for (auto const& prev : State(sub, key).previous())
+        {
+            auto const index = indexOf(prev);
+
+            if (dist[index] == UNSOLVABLE)
+            {
+                dist[index] = depth;
+                queue.push_back(prev);
+            }
+        }
+    }
+}
+
+unsigned PatternDatabase::operator()(StateKey const& key) const
+{
+    auto const& codec = m_board->codec();
+    std::array<std::uint8_t, MAX_PETS> codes;
+
+    for (std::size_t i = 0, numpets = codec.numPets(); i < numpets; ++i)
+        codes[i] = static_cast<std::uint8_t>(petCode(codec.pet(key, i), m_board->house(i)));
+
+    std::size_t const car = codec.car(key);
+    std::size_t const numcells = m_board->numCells();
+    unsigned bound = 0;
+
+    for (std::size_t isubset = 0; isubset < m_subsets.size(); ++isubset)
+    {
+        auto const& subset = m_subsets[isubset];
+
+        std::size_t code = 0;
+        for (std::size_t i = m_subsetsize; i-- > 0; )
+            code = code * 3 + codes[subset[i]];
+
+        auto const d = m_distances[isubset * m_tablesize + car + numcells * code];
+
+        if (d == UNSOLVABLE)
+            return Heuristic::INFINITE;
+
+        bound = std::max<unsigned>(bound, d);
+    }
+
+    return bound;
+}
+
+// The tables also depend on where the animals start: that is where a waiting pet is
+std::uint64_t PatternDatabase::fingerprint(Board const& board)
+{
+    std::size_t seed = board.layout();
+
+    for (std::size_t i = 0; i < board.pets().size(); ++i)
+        boost::hash_combine(seed, board.start(i));
+
+    return seed;
+}
+
+std::shared_ptr<PatternDatabase const> PatternDatabase::load(Board const& board, std::string const& dir, unsigned threads)
+{
+    if (dir.empty())
+        return std::make_shared<PatternDatabase>(board, threads);
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.pdb", static_cast<unsigned long long>(fingerprint(board)));
+    std::string const filename = dir + '/' + name;
+
+    std::shared_ptr<PatternDatabase> pdb(new PatternDatabase());
+
+    if (pdb->read(filename, board))
+        return pdb;
+
+    pdb = std::make_shared<PatternDatabase>(board, threads);
+    pdb->write(filename, board);
+
+    return pdb;
+}
+
+bool PatternDatabase::read(std::string const& filename, Board const& board)
+{
+    std::ifstream ifs(filename, std::ios::binary);
+
+    std::uint32_t magic = 0;
+    std::uint64_t fp = 0;
+    std::uint32_t numcells = 0;
+    std::uint32_t numpets = 0;
+    std::uint32_t subsetsize = 0;
+    std::uint32_t numsubsets = 0;
+
+    if (!readValue(ifs, magic) || !readValue(ifs, fp) || !readValue(ifs, numcells) || !readValue(ifs, numpets)
+            || !readValue(ifs, subsetsize) || !readValue(ifs, numsubsets))
+        return false;
+
+    if (magic != FILE_MAGIC || fp != fingerprint(board) || numcells != board.numCells()
+            || numpets != board.pets().size() || subsetsize != std::min(MAX_SUBSET, board.pets().size())
+            || numsubsets != binomial(numpets, subsetsize))
+        return false;
+
+    m_board = &board;
+    m_subsetsize = subsetsize;
+    m_tablesize = numcells;
+
+    for (std::size_t i = 0; i < m_subsetsize; ++i)
+        m_tablesize *= 3;
+
+    m_subsets.resize(numsubsets);
+    m_distances.resize(numsubsets * m_tablesize);
+
+    return ifs.read(reinterpret_cast<char*>(m_subsets.data()), static_cast<std::streamsize>(m_subsets.size() * sizeof(Subset)))
+            && ifs.read(reinterpret_cast<char*>(m_distances.data()), static_cast<std::streamsize>(m_distances.size()));
+}
+
+// Written aside and renamed, so that tasks reading the same layout never see half a file
+void PatternDatabase::write(std::string const& filename, Board const& board) const
+{
+    std::string const tmpname = filename + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+
+    {
+        std::ofstream ofs(tmpname, std::ios::binary);
+
+        writeValue(ofs, FILE_MAGIC);
+        writeValue(ofs, fingerprint(board));
+        writeValue(ofs, static_cast<std::uint32_t>(board.numCells()));
+        writeValue(ofs, static_cast<std::uint32_t>(board.pets().size()));
+        writeValue(ofs, static_cast<std::uint32_t>(m_subsetsize));
+        writeValue(ofs, static_cast<std::uint32_t>(m_subsets.size()));
+        ofs.write(reinterpret_cast<char const*>(m_subsets.data()), static_cast<std::streamsize>(m_subsets.size() * sizeof(Subset)));
+        ofs.write(reinterpret_cast<char const*>(m_distances.data()), static_cast<std::streamsize>(m_distances.size()));
+
+        if (!ofs)
+        {
+            std::remove(tmpname.c_str());
+            throw std::runtime_error("Can't write pattern database " + filename);
+        }
+    }
+
+    std::rename(tmpname.c_str(), filename.c_str());
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "board.h"
+
+// Exact number of moves to deliver every subset of MAX_SUBSET pets (all pets if there
+// are fewer), the other pets being ignored. Dropping pets can only make a puzzle easier,
+// so each of these is an admissible and consistent bound, and so is their maximum.
+// Smaller subsets are not stored: they never give more than a subset containing them.
+//
+// A subset's table is indexed by a perfect hash of the state restricted to it: the car cell,
+// and for each of its pets whether the animal waits at its start, rides in the car or is home.
+class PatternDatabase
+{
+public:
+
+    static constexpr std::size_t MAX_SUBSET = 3;
+
+    // Builds the tables, one subset per thread at a time. 0 threads is one per hardware thread.
+    PatternDatabase(Board const& board, unsigned threads);
+
+    // Reads the tables of the board from the directory if they are there, otherwise builds
+    // and saves them. An empty directory only builds.
+    static std::shared_ptr<PatternDatabase const> load(Board const& board, std::string const& dir, unsigned threads);
+
+    std::size_t numSubsets() const { return m_subsets.size(); }
+
+    // Moves left at least, Heuristic::INFINITE if some subset can not be delivered any more
+    unsigned operator()(StateKey const& key) const;
+
+private:
+
+    PatternDatabase() = default;
+
+    using Subset = std::array<std::uint8_t, MAX_SUBSET>;
+
+    static constexpr std::uint8_t UNSOLVABLE = 0xff;
+
+    void buildSubset(std::size_t isubset);
+
+    static std::uint64_t fingerprint(Board const& board);
+    bool read(std::string const& filename, Board const& board);
+    void write(std::string const& filename, Board const& board) const;
+
+private:
+    Board const* m_board = nullptr;
+    std::size_t m_subsetsize = 0;
+    std::size_t m_tablesize = 0;        // numCells() * 3^m_subsetsize
+    std::vector<Subset> m_subsets;
+    std::vector<std::uint8_t> m_distances;  // m_tablesize per subset
+};
@@ -1,31 +1,20 @@
 #include "pet.h"
 
-#include <boost/container_hash/hash.hpp>
+#include <stdexcept>
+#include <string>
 
-std::size_t hash_value(Pet const& p)
+void PetPos::followCar(Cell car, Cell house, bool capture)
 {
-    std::size_t h = 0;
-
-    boost::hash_combine(h, p.m_name);
-    boost::hash_combine(h, p.m_house);
-    boost::hash_combine(h, p.m_animal);
-    boost::hash_combine(h, p.m_captured);
-
-    return h;
-}
-
-void Pet::followCar(Position const& pos, bool capture)
-{
-    if (isHome())
+    if (isHome(house))
         return;
 
-    if (isCaptured())
-        m_animal = pos;
-    else if(m_animal == pos && capture)
-        setCaptured(true);
+    if (captured)
+        animal = car;
+    else if (animal == car && capture)
+        captured = true;
 
-    if (m_animal == m_house) // home
-        setCaptured(false);
+    if (animal == house) // home
+        captured = false;
 }
 
 
@@ -4,6 +4,18 @@
 
 #include "definitions.h"
 
+// Part of a pet that changes while the car drives around
+struct PetPos
+{
+    Cell animal = INVALID_CELL;
+    bool captured = false;
+
+    bool isHome(Cell house) const { return !captured && animal == house; }
+
+    void followCar(Cell car, Cell house, bool capture);
+};
+
+// Part of a pet that never changes during a search: its name, its house and where the animal starts
 class Pet : boost::equality_comparable1<Pet>
 {
 public:
@@ -25,22 +37,15 @@ public:
     {
         return l.m_name == r.m_name
                 && l.m_animal == r.m_animal
-                && l.m_house == r.m_house
-                && l.m_captured == r.m_captured;
+                && l.m_house == r.m_house;
     }
 
-    friend std::size_t hash_value(Pet const& p);
-
     static char asAnimalName(char c) { return static_cast<char>(std::tolower(c)); }
 
     char animalName() const { return m_name; }
     char houseName() const { return static_cast<char>(std::toupper(m_name)); }
     Position const& housePosition() const { return m_house; }
     Position const& animalPosition() const { return m_animal; }
-    bool isHome() const { return !isCaptured() && m_animal == m_house; }
-    bool isCaptured() const { return m_captured; }
-
-    void followCar(Position const& pos, bool capture);
 
 private:
 
@@ -50,13 +55,10 @@ private:
         , m_house(house)
     {}
 
-    void setCaptured(bool yes) { m_captured = yes; }
-
 private:
     char m_name;
     Position m_animal;
     Position m_house;
-    bool m_captured = false;
 };
 
 using Pets = std::vector<Pet>;
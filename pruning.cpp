@@ -0,0 +1,112 @@
+#include "pruning.h"
+
+#include <stdexcept>
+
+namespace
+{
+
+struct PruneRuleName
+{
+    PruneRule rule;
+    char const* name;
+};
+
+constexpr PruneRuleName pruneRuleNames[] =
+{
+    { PruneRule::CaptureWhenRoom, "capture" },
+    { PruneRule::NoReturn, "noreturn" },
+};
+
+} // namespace
+
+unsigned pruneRulesFromNames(std::string const& names)
+{
+    unsigned rules = 0;
+
+    for (std::size_t begin = 0; begin <= names.size(); )
+    {
+        auto end = names.find(',', begin);
+        if (end == std::string::npos)
+            end = names.size();
+
+        auto const name = names.substr(begin, end - begin);
+        begin = end + 1;
+
+        if (name == "none")
+            continue;
+
+        bool found = false;
+
+        for (auto const& rn : pruneRuleNames)
+        {
+            if (name == "all" || name == rn.name)
+            {
+                rules |= pruneBit(rn.rule);
+                found = true;
+            }
+        }
+
+        if (!found)
+            throw std::invalid_argument("Unknown pruning rule " + name);
+    }
+
+    return rules;
+}
+
+char const* pruneRuleName(PruneRule rule)
+{
+    for (auto const& rn : pruneRuleNames)
+    {
+        if (rule == rn.rule)
+            return rn.name;
+    }
+
+    return "?";
+}
+
+void Pruning::apply(StateKey const* grandparent, Successors& succs, SuccessorHashes* hashes)
+{
+    auto const& codec = m_board.codec();
+
+    // State::adjacent() puts the capture right after the pass by, both with the car on the animal.
+    // Once no more pets are left out of their houses than fit in the car, the captured pet
+    // simply rides along until its house: whatever the pass by leads to, the capture does no later.
+    if (has(PruneRule::CaptureWhenRoom))
+    {
+        for (std::size_t i = 0; i + 1 < succs.size(); ++i)
+        {
+            auto const& capture = succs[i + 1];
+
+            if (codec.car(succs[i]) != codec.car(capture))
+                continue;
+
+            int away = 0;
+            for (std::size_t p = 0, numpets = codec.numPets(); p < numpets; ++p)
+                away += codec.pet(capture, p).isHome(m_board.house(p)) ? 0 : 1;
+
+            if (away <= m_board.capacity())
+            {
+                succs.erase(succs.begin() + static_cast<std::ptrdiff_t>(i));
+                if (hashes)
+                    hashes->erase(hashes->begin() + static_cast<std::ptrdiff_t>(i));
+                ++m_counts[static_cast<std::size_t>(PruneRule::CaptureWhenRoom)];
+            }
+        }
+    }
+
+    // Going straight back is never part of a shortest way anywhere
+    if (has(PruneRule::NoReturn) && grandparent)
+    {
+        for (std::size_t i = 0; i < succs.size(); ++i)
+        {
+            if (succs[i] == *grandparent)
+            {
+                succs.erase(succs.begin() + static_cast<std::ptrdiff_t>(i));
+                if (hashes)
+                    hashes->erase(hashes->begin() + static_cast<std::ptrdiff_t>(i));
+                ++m_counts[static_cast<std::size_t>(PruneRule::NoReturn)];
+                break;
+            }
+        }
+    }
+}
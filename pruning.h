@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <string>
+
+#include "state.h"
+
+// Rules that drop successors which can not be on a shortest solution, or which are no
+// better than a sibling. They hold for searches that only go forward from the initial state.
+enum class PruneRule
+{
+    CaptureWhenRoom,    // no "pass by" next to a "capture" once the car can never be full again
+    NoReturn,           // no successor that is the state the parent was reached from
+};
+
+constexpr std::size_t NUM_PRUNE_RULES = 2;
+
+using PruneCounts = std::array<std::size_t, NUM_PRUNE_RULES>;
+
+constexpr unsigned pruneBit(PruneRule rule) { return 1u << static_cast<unsigned>(rule); }
+
+// Comma separated rule names, "all" or "none"
+unsigned pruneRulesFromNames(std::string const& names);
+char const* pruneRuleName(PruneRule rule);
+
+// The enabled rules of one search, with the number of successors each of them has removed
+class Pruning
+{
+public:
+
+    Pruning(Board const& board, unsigned rules) : m_board(board), m_rules(rules) {}
+
+    bool enabled() const { return m_rules != 0; }
+
+    // Successors of a state reached from grandparent, which is null for the initial state.
+    // Their hashes, if given, are dropped along with them.
+    void apply(StateKey const* grandparent, Successors& succs, SuccessorHashes* hashes = nullptr);
+
+    PruneCounts const& counts() const { return m_counts; }
+
+private:
+
+    bool has(PruneRule rule) const { return (m_rules & pruneBit(rule)) != 0; }
+
+private:
+    Board const& m_board;
+    unsigned m_rules;
+    PruneCounts m_counts{};
+};
@@ -0,0 +1,96 @@
+#include "puzzle.h"
+
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+
+constexpr std::size_t NUM_NAMES = 26;
+
+// Chars that go to the streets as they are
+constexpr std::array<bool, 256> makeStreetChars()
+{
+    std::array<bool, 256> table{};
+    table[static_cast<unsigned char>(ROAD)] = true;
+    table[static_cast<unsigned char>(WAY)] = true;
+    table[static_cast<unsigned char>(NOWAY)] = true;
+    return table;
+}
+
+constexpr auto STREET_CHARS = makeStreetChars();
+
+} // namespace
+
+Puzzle parsePuzzle(std::string_view text)
+{
+    Puzzle puzzle;
+    std::array<Pet::Builder, NUM_NAMES> builders;
+    std::array<bool, NUM_NAMES> used{};
+
+    // Rows are copied as they are, then the few chars that are not streets are patched
+    std::vector<char> cells(text.size());
+    char* out = cells.data();
+
+    int row = 0;
+    int width = -1;
+
+    for (char const* pos = text.data(), * const end = pos + text.size(); pos != end; ++row)
+    {
+        auto const* eol = static_cast<char const*>(std::memchr(pos, '\n', static_cast<std::size_t>(end - pos)));
+        char const* const next = eol ? eol + 1 : end;
+
+        if (!eol)
+            eol = end;
+        else if (eol != pos && eol[-1] == '\r')
+            --eol;
+
+        auto const size = static_cast<int>(eol - pos);
+
+        if (width < 0)
+            width = size;
+        else if (width != size)
+            throw std::runtime_error("Lines of different lengths in input file");
+
+        std::memcpy(out, pos, static_cast<std::size_t>(size));
+
+        for (int col = 0; col < size; ++col)
+        {
+            char const c = out[col];
+
+            if (STREET_CHARS[static_cast<unsigned char>(c)])
+                continue;
+
+            if (c == CAR)
+                puzzle.car = { row, col };
+            else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))
+            {
+                auto const index = static_cast<std::size_t>(Pet::asAnimalName(c) - 'a');
+                builders[index].addPos(c, { row, col });
+                used[index] = true;
+            }
+            else
+                throw std::runtime_error("Bad char in input file");
+
+            out[col] = ROAD;
+        }
+
+        out += size;
+        pos = next;
+    }
+
+    if (puzzle.car == INVALID_POSITION)
+        throw std::runtime_error("No car position specified.");
+
+    for (std::size_t i = 0; i < NUM_NAMES; ++i)
+    {
+        if (used[i])
+            puzzle.pets.push_back(builders[i].build());
+    }
+
+    cells.resize(static_cast<std::size_t>(out - cells.data()));
+    puzzle.streets = Streets(row, width, std::move(cells));
+
+    return puzzle;
+}
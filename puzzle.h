@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string_view>
+
+#include "streets.h"
+#include "pet.h"
+
+// Contents of a puzzle as written: the streets, the pets and where the car starts
+struct Puzzle
+{
+    Streets streets;
+    Pets pets;
+    Car car = INVALID_POSITION;
+};
+
+// Parses a puzzle in one pass over its text, rows separated by '\n' or "\r\n".
+// Animals, houses and the car stand on roads; pets are ordered by name.
+Puzzle parsePuzzle(std::string_view text);
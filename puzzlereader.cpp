@@ -0,0 +1,164 @@
+#include "puzzlereader.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+
+constexpr char HEADER = '#';
+
+} // namespace
+
+PuzzleReader::PuzzleReader(std::string const& filename)
+    : m_source(filename == "-" ? "stdin" : filename)
+{
+    if (filename == "-")
+    {
+        m_stream = &std::cin;
+        return;
+    }
+
+    if (map(filename))
+        return;
+
+    m_file = std::make_unique<std::ifstream>(filename);
+
+    if (!*m_file)
+        throw std::runtime_error("Can't open file " + filename);
+
+    m_stream = m_file.get();
+}
+
+PuzzleReader::~PuzzleReader()
+{
+    if (m_data)
+        ::munmap(const_cast<char*>(m_data), m_size);
+}
+
+// Maps a non-empty regular file, anything else is left to the stream
+bool PuzzleReader::map(std::string const& filename)
+{
+    int const fd = ::open(filename.c_str(), O_RDONLY);
+
+    if (fd < 0)
+        throw std::runtime_error("Can't open file " + filename);
+
+    struct stat st;
+
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void* const data = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if (data == MAP_FAILED)
+        return false;
+
+    ::madvise(data, static_cast<std::size_t>(st.st_size), MADV_SEQUENTIAL);
+
+    m_data = static_cast<char const*>(data);
+    m_size = static_cast<std::size_t>(st.st_size);
+
+    return true;
+}
+
+// Next line without its end of line; for mapped input it points into the mapping
+bool PuzzleReader::nextLine(std::string_view& line)
+{
+    if (m_data)
+    {
+        if (m_pos == m_size)
+            return false;
+
+        char const* const begin = m_data + m_pos;
+        char const* const end = std::find(begin, m_data + m_size, '\n');
+
+        line = std::string_view(begin, static_cast<std::size_t>(end - begin));
+        m_pos = std::min(m_size, static_cast<std::size_t>(end - m_data) + 1);
+    }
+    else
+    {
+        if (!std::getline(*m_stream, m_line))
+            return false;
+
+        line = m_line;
+    }
+
+    if (!line.empty() && line.back() == '\r')
+        line.remove_suffix(1);
+
+    return true;
+}
+
+bool PuzzleReader::next(PuzzleText& puzzle)
+{
+    std::string_view line;
+    char const* begin = nullptr;
+    char const* end = nullptr;
+
+    m_text.clear();
+
+    for (;;)
+    {
+        bool const more = nextLine(line);
+        bool const header = more && !line.empty() && line.front() == HEADER;
+        bool const started = m_data ? begin != nullptr : !m_text.empty();
+
+        if (!more || header || line.empty())
+        {
+            if (started)
+            {
+                ++m_count;
+
+                if (!m_header.empty())
+                    puzzle.name = std::move(m_header);
+                else if (m_count == 1)
+                    puzzle.name = m_source;
+                else
+                    puzzle.name = m_source + HEADER + std::to_string(m_count);
+
+                puzzle.text = m_data ? std::string_view(begin, static_cast<std::size_t>(end - begin)) : std::string_view(m_text);
+                m_header.clear();
+            }
+
+            if (header)
+            {
+                line.remove_prefix(1);
+                auto const first = line.find_first_not_of(' ');
+                m_header = first == std::string_view::npos ? std::string() : std::string(line.substr(first));
+            }
+
+            if (started)
+                return true;
+
+            if (!more)
+                return false;
+
+            continue;
+        }
+
+        if (m_data)
+        {
+            if (!begin)
+                begin = line.data();
+
+            end = line.data() + line.size();
+        }
+        else
+        {
+            m_text.append(line.data(), line.size());
+            m_text.push_back('\n');
+        }
+    }
+}
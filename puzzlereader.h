@@ -0,0 +1,55 @@
+#pragma once
+
+#include <istream>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// One puzzle cut out of a batch. The text stays valid until the next call to PuzzleReader::next().
+struct PuzzleText
+{
+    std::string name;
+    std::string_view text;
+};
+
+// Splits a batch of puzzles into single ones, one at a time.
+// Puzzles are separated by empty lines or by a header line starting with '#',
+// the rest of which names the puzzle that follows. Unnamed puzzles are called after
+// the file, with their 1-based number appended from the second one on.
+// Regular files are memory mapped; stdin ("-") and other streams are read line by line
+// and only the current puzzle is kept in memory.
+class PuzzleReader
+{
+public:
+
+    explicit PuzzleReader(std::string const& filename);
+    ~PuzzleReader();
+
+    PuzzleReader(PuzzleReader const&) = delete;
+    PuzzleReader& operator=(PuzzleReader const&) = delete;
+
+    // Returns false when the input is exhausted
+    bool next(PuzzleText& puzzle);
+
+private:
+
+    bool map(std::string const& filename);
+    bool nextLine(std::string_view& line);
+
+private:
+    std::string m_source;
+
+    // Memory mapped input
+    char const* m_data = nullptr;
+    std::size_t m_size = 0;
+    std::size_t m_pos = 0;
+
+    // Streamed input
+    std::unique_ptr<std::istream> m_file;
+    std::istream* m_stream = nullptr;
+    std::string m_line;
+    std::string m_text;
+
+    std::size_t m_count = 0;
+    std::string m_header;
+};
@@ -0,0 +1,91 @@
+#include "roadgraph.h"
+
+#include <stdexcept>
+
+RoadGraph::RoadGraph(Streets const& streets)
+{
+    if (streets.empty())
+        throw std::runtime_error("Empty streets");
+
+    m_rows = streets.height();
+    m_cols = streets.width();
+    m_junctioncols = (m_cols + 1) / 2;
+
+    m_cellAt.assign(static_cast<std::size_t>(((m_rows + 1) / 2) * m_junctioncols), INVALID_CELL);
+
+    for (int row = 0; row < m_rows; row += 2)
+    {
+        for (int col = 0; col < m_cols; col += 2)
+        {
+            if (streets.at(row, col) == NOWAY)
+                continue;
+
+            if (m_positions.size() >= INVALID_CELL)
+                throw std::runtime_error("Streets are too large");
+
+            m_cellAt[static_cast<std::size_t>((row / 2) * m_junctioncols + col / 2)] = static_cast<Cell>(m_positions.size());
+            m_positions.emplace_back(row, col);
+        }
+    }
+
+    Position const incs[] =
+    {
+        { 0, 1 }, { 1, 0 }, { 0, -1 }, { -1, 0 },
+    };
+
+    m_neighbors.resize(numCells());
+    m_degrees.assign(numCells(), 0);
+
+    for (std::size_t cell = 0; cell < numCells(); ++cell)
+    {
+        Position const pos = m_positions[cell];
+
+        for (auto const& inc : incs)
+        {
+            Position const way(pos.first + inc.first, pos.second + inc.second);
+
+            if (!streets.contains(way) || streets.at(way) == NOWAY)
+                continue;
+
+            Cell const next = cellOf({ way.first + inc.first, way.second + inc.second });
+
+            if (next != INVALID_CELL)
+                m_neighbors[cell][m_degrees[cell]++] = next;
+        }
+    }
+
+    computeDistances();
+}
+
+void RoadGraph::computeDistances()
+{
+    auto const numcells = numCells();
+
+    m_distances.assign(numcells * numcells, UNREACHABLE);
+
+    std::vector<Cell> queue;
+    queue.reserve(numcells);
+
+    for (std::size_t from = 0; from < numcells; ++from)
+    {
+        auto* dist = &m_distances[from * numcells];
+
+        queue.clear();
+        queue.push_back(static_cast<Cell>(from));
+        dist[from] = 0;
+
+        for (std::size_t head = 0; head < queue.size(); ++head)
+        {
+            Cell const cell = queue[head];
+
+            for (Cell next : neighbors(cell))
+            {
+                if (dist[next] == UNREACHABLE)
+                {
+                    dist[next] = static_cast<Distance>(dist[cell] + 1);
+                    queue.push_back(next);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+
+#include <boost/range/iterator_range.hpp>
+
+#include "definitions.h"
+#include "streets.h"
+
+// Junctions of the streets and the roads between them, built once per puzzle.
+// Only junctions the car can stand on get a Cell, numbered row by row.
+class RoadGraph
+{
+public:
+
+    static constexpr std::size_t MAX_NEIGHBORS = 4;
+
+    using Neighbors = boost::iterator_range<Cell const*>;
+
+    explicit RoadGraph(Streets const& streets);
+
+    std::size_t numCells() const { return m_positions.size(); }
+
+    // INVALID_CELL unless the position is a junction with a road
+    Cell cellOf(Position const& pos) const;
+    Position positionOf(Cell cell) const { return m_positions[cell]; }
+
+    // Junctions one car move away, in the order right, down, left, up
+    Neighbors neighbors(Cell cell) const
+    {
+        auto const* first = m_neighbors[cell].data();
+        return { first, first + m_degrees[cell] };
+    }
+
+    // Fewest car moves between two junctions, UNREACHABLE if there is no road
+    Distance distance(Cell from, Cell to) const { return m_distances[from * numCells() + to]; }
+
+private:
+
+    void computeDistances();
+
+private:
+    int m_rows = 0;
+    int m_cols = 0;
+    int m_junctioncols = 0;
+    std::vector<Cell> m_cellAt;         // per junction, row by row
+    std::vector<Position> m_positions;  // per cell
+    std::vector<std::array<Cell, MAX_NEIGHBORS>> m_neighbors;
+    std::vector<std::uint8_t> m_degrees;
+    std::vector<Distance> m_distances;  // numCells() x numCells()
+};
+
+inline Cell RoadGraph::cellOf(Position const& pos) const
+{
+    if (pos.first < 0 || pos.second < 0 || pos.first >= m_rows || pos.second >= m_cols
+            || pos.first % 2 != 0 || pos.second % 2 != 0)
+        return INVALID_CELL;
+
+    return m_cellAt[static_cast<std::size_t>((pos.first / 2) * m_junctioncols + pos.second / 2)];
+}
@@ -0,0 +1,101 @@
+#include "solutioncache.h"
+
+#include <algorithm>
+
+#include <boost/container_hash/hash.hpp>
+
+namespace
+{
+
+// Node of the list, node of the index and its bucket
+constexpr std::size_t BYTES_PER_ENTRY = 96;
+
+} // namespace
+
+SolutionCache::SolutionCache(std::size_t maxbytes)
+    : m_shards(NUM_SHARDS)
+    , m_maxentries(std::max<std::size_t>(1, maxbytes / BYTES_PER_ENTRY / NUM_SHARDS))
+{
+}
+
+std::size_t SolutionCache::KeyHash::operator()(Key const& key) const
+{
+    std::size_t seed = hash_value(key.state);
+    boost::hash_combine(seed, key.layout);
+    return seed;
+}
+
+SolutionCache::Shard& SolutionCache::shardOf(Key const& key)
+{
+    // The low bits pick the bucket inside the shard
+    return m_shards[(KeyHash()(key) >> 32) % NUM_SHARDS];
+}
+
+std::optional<SolutionCache::Entry> SolutionCache::find(std::uint64_t layout, StateKey const& key)
+{
+    Key const k{ layout, key };
+    auto& shard = shardOf(k);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto const it = shard.index.find(k);
+
+    if (it == shard.index.end())
+        return std::nullopt;
+
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    ++m_hits;
+
+    return it->second->second;
+}
+
+void SolutionCache::insert(std::uint64_t layout, StateKey const& key, Entry const& entry)
+{
+    Key const k{ layout, key };
+    auto& shard = shardOf(k);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto const it = shard.index.find(k);
+
+    if (it != shard.index.end())
+    {
+        it->second->second = entry;
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        return;
+    }
+
+    if (shard.index.size() >= m_maxentries)
+    {
+        shard.index.erase(shard.lru.back().first);
+        shard.lru.pop_back();
+    }
+
+    shard.lru.emplace_front(k, entry);
+    shard.index.emplace(k, shard.lru.begin());
+}
+
+void SolutionCache::insertPath(std::uint64_t layout, std::vector<StateKey> const& keys)
+{
+    for (std::size_t i = 0; i < keys.size(); ++i)
+    {
+        Entry entry;
+        entry.distance = static_cast<Distance>(keys.size() - 1 - i);
+
+        if (i + 1 < keys.size())
+            entry.next = keys[i + 1];
+
+        insert(layout, keys[i], entry);
+    }
+}
+
+std::size_t SolutionCache::size() const
+{
+    std::size_t total = 0;
+
+    for (auto const& shard : m_shards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.index.size();
+    }
+
+    return total;
+}
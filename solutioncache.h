@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "definitions.h"
+#include "statekey.h"
+
+// Exact distances to the goal of states that lie on solutions found earlier, shared by
+// the tasks of a batch. Entries are keyed by the layout of the board (streets and houses)
+// and the state key, so puzzles that only differ in where the pets and the car start
+// share them. Once the memory cap is reached the least recently used entries go first.
+// Safe to use from several threads: the keys are spread over independently locked shards.
+class SolutionCache
+{
+public:
+
+    struct Entry
+    {
+        Distance distance = 0;
+        StateKey next;          // one move closer to the goal, meaningless at distance 0
+    };
+
+    explicit SolutionCache(std::size_t maxbytes);
+
+    std::optional<Entry> find(std::uint64_t layout, StateKey const& key);
+    void insert(std::uint64_t layout, StateKey const& key, Entry const& entry);
+
+    // Every state of a shortest solution, from the initial one to the final one
+    void insertPath(std::uint64_t layout, std::vector<StateKey> const& keys);
+
+    std::size_t size() const;
+    std::size_t hits() const { return m_hits; }
+
+private:
+
+    struct Key
+    {
+        std::uint64_t layout;
+        StateKey state;
+
+        friend bool operator==(Key const& l, Key const& r) { return l.layout == r.layout && l.state == r.state; }
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()(Key const& key) const;
+    };
+
+    using Lru = std::list<std::pair<Key, Entry>>;   // most recently used first
+
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        Lru lru;
+        std::unordered_map<Key, Lru::iterator, KeyHash> index;
+    };
+
+    static constexpr std::size_t NUM_SHARDS = 16;
+
+    Shard& shardOf(Key const& key);
+
+private:
+    std::vector<Shard> m_shards;
+    std::size_t m_maxentries;       // per shard
+    std::atomic<std::size_t> m_hits{ 0 };
+};
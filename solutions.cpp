@@ -0,0 +1,182 @@
+#include "solver.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+
+// Walks back from a final state through the predecessors of every state, keeping to
+// the states the breadth first search has reached close enough to the start.
+// The depth of a state is its distance from the start, so a state deeper than the moves
+// left can't be on the way, and every branch kept ends at the start.
+class PathEnumerator
+{
+public:
+
+    PathEnumerator(BoardPtr const& board, StateStore const& store, std::vector<Distance> const& depths, StateId inistate,
+                   SolutionSink const& sink)
+        : m_board(board)
+        , m_store(store)
+        , m_depths(depths)
+        , m_inistate(inistate)
+        , m_sink(sink)
+        , m_onpath(store.size(), 0)
+    {}
+
+    // Passes every simple path of exactly length moves from the start to the final state to the sink,
+    // returns false once the sink wants no more
+    bool enumerate(StateId final, unsigned length, std::size_t& found, std::size_t limit, std::size_t expanded)
+    {
+        m_found = &found;
+        m_limit = limit;
+        m_expanded = expanded;
+
+        return walk(final, length);
+    }
+
+private:
+
+    bool walk(StateId id, unsigned left)
+    {
+        m_path.push_back(id);
+        m_onpath[id] = 1;
+
+        bool const more = id == m_inistate ? (left != 0 || emit()) : step(id, left);
+
+        m_onpath[id] = 0;
+        m_path.pop_back();
+
+        return more;
+    }
+
+    bool step(StateId id, unsigned left)
+    {
+        if (left == 0)
+            return true;
+
+        auto prevs = m_store.state(id).previous();
+        std::sort(prevs.begin(), prevs.end(), [](StateKey const& l, StateKey const& r) { return l.words < r.words; });
+        prevs.erase(std::unique(prevs.begin(), prevs.end()), prevs.end());
+
+        for (auto const& key : prevs)
+        {
+            StateId const prev = m_store.find(key);
+
+            // A solution ends at the first final state it reaches
+            if (prev == INVALID_STATE || m_onpath[prev] || m_depths[prev] > left - 1 || m_store.isFinal(prev))
+                continue;
+
+            if (!walk(prev, left - 1))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool emit()
+    {
+        StatePath solpath{ m_board, {}, m_expanded };
+
+        for (auto it = m_path.rbegin(); it != m_path.rend(); ++it)
+            solpath.keys.push_back(m_store.key(*it));
+
+        ++*m_found;
+
+        return m_sink(std::move(solpath)) && *m_found != m_limit;
+    }
+
+private:
+    BoardPtr const& m_board;
+    StateStore const& m_store;
+    std::vector<Distance> const& m_depths;
+    StateId const m_inistate;
+    SolutionSink const& m_sink;
+    std::vector<char> m_onpath;
+    std::vector<StateId> m_path;
+    std::size_t* m_found = nullptr;
+    std::size_t m_limit = 0;
+    std::size_t m_expanded = 0;
+};
+
+} // namespace
+
+// Breadth first search one depth at a time. Once a depth is complete, the solutions of that
+// many moves are walked back from the final states reached so far. Final states are never
+// expanded, and past the optimal depth the search goes on only as long as more solutions are wanted.
+std::size_t streamSolutions(BoardPtr const& board, StateKey const& inikey, std::size_t count, SolutionSink const& sink)
+{
+    StateStore store(board);
+    std::vector<Distance> depths;
+    std::vector<StateId> frontier;
+    std::vector<StateId> next;
+    std::vector<StateId> finals;
+    SuccessorHashes hashes;
+    std::size_t expanded = 0;
+    std::size_t found = 0;
+
+    StateId const inistate = store.add(inikey);
+    depths.push_back(0);
+
+    if (store.isFinal(inistate))
+    {
+        sink({ board, { inikey } });
+        return 1;
+    }
+
+    frontier.push_back(inistate);
+
+    for (unsigned length = 1; length <= store.size(); ++length)
+    {
+        stats::frontier(frontier.size());
+
+        for (StateId const id : frontier)
+        {
+            ++expanded;
+
+            auto const succs = store.successors(id, hashes);
+
+            for (std::size_t i = 0; i < succs.size(); ++i)
+            {
+                auto const before = store.size();
+                StateId const n = store.add(succs[i], hashes[i]);
+
+                if (store.size() == before)
+                    continue;
+
+                depths.push_back(static_cast<Distance>(length));
+
+                if (store.isFinal(n))
+                    finals.push_back(n);
+                else
+                    next.push_back(n);
+            }
+        }
+
+        frontier.swap(next);
+        next.clear();
+
+        // Past the last depth, only the walks back are left to do
+        if (frontier.empty())
+        {
+            std::vector<StateId>().swap(frontier);
+            std::vector<StateId>().swap(next);
+        }
+
+        PathEnumerator paths(board, store, depths, inistate, sink);
+
+        for (StateId const final : finals)
+        {
+            if (!paths.enumerate(final, length, found, count, expanded))
+                return found;
+        }
+
+        if ((found != 0 && count == ALL_OPTIMAL) || (frontier.empty() && finals.empty()))
+            break;
+    }
+
+    if (found == 0)
+        throw std::runtime_error("No solution");
+
+    return found;
+}
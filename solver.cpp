@@ -0,0 +1,133 @@
+#include "solver.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+
+struct SolverName
+{
+    Solver solver;
+    char const* name;
+};
+
+constexpr SolverName solverNames[] =
+{
+    { Solver::BFS, "bfs" },
+    { Solver::AStar, "astar" },
+    { Solver::IDAStar, "idastar" },
+    { Solver::Bidirectional, "bidir" },
+    { Solver::ParallelBFS, "pbfs" },
+    { Solver::ExternalBFS, "ebfs" },
+    { Solver::Greedy, "greedy" },
+};
+
+// Moves of a greedy route, a bound on the shortest one. Its work is not counted
+// in the stats of the search it bounds.
+unsigned greedyBound(BoardPtr const& board, StateKey const& inikey)
+{
+    stats::Recorder recorder;
+    unsigned bound = NO_BOUND;
+
+    try
+    {
+        auto const route = solveGreedy(board, inikey);
+        if (!route.keys.empty())
+            bound = static_cast<unsigned>(route.keys.size() - 1);
+    }
+    catch (std::runtime_error const&)
+    {
+        // No route found, the exact search goes unbounded
+    }
+
+    recorder.discard();
+    return bound;
+}
+
+StatePath dispatch(SolverConfig const& config, BoardPtr const& board, StateKey const& inikey)
+{
+    bool const informed = config.solver == Solver::AStar || config.solver == Solver::IDAStar;
+    std::shared_ptr<PatternDatabase const> patterns;
+
+    if (informed && config.patterns)
+        patterns = PatternDatabase::load(*board, config.patternDir, config.threads);
+
+    // Any route is a bound on the shortest one
+    bool const bounded = config.upperBound && (config.solver == Solver::BFS || config.solver == Solver::AStar);
+    unsigned const bound = bounded ? greedyBound(board, inikey) : NO_BOUND;
+
+    switch (config.solver)
+    {
+    case Solver::AStar:
+        return solveAStar(board, inikey, config.cache.get(), patterns.get(), config.pruning, bound);
+    case Solver::IDAStar:
+        return solveIdaStar(board, inikey, patterns.get(), config.pruning);
+    case Solver::Bidirectional:
+        return solveBidirectional(board, inikey, config.cache.get());
+    case Solver::ParallelBFS:
+        return solveParallelBfs(board, inikey, config.threads);
+    case Solver::ExternalBFS:
+        return solveExternalBfs(board, inikey, config.memory, config.tempDir);
+    case Solver::Greedy:
+        return solveGreedy(board, inikey);
+    case Solver::BFS:
+    default:
+        return solveBfs(board, inikey, config.pruning, bound, config.checkpoint);
+    }
+}
+
+} // namespace
+
+Solver solverFromName(std::string const& name)
+{
+    for (auto const& sn : solverNames)
+    {
+        if (name == sn.name)
+            return sn.solver;
+    }
+
+    throw std::invalid_argument("Unknown solver " + name);
+}
+
+char const* solverName(Solver solver)
+{
+    for (auto const& sn : solverNames)
+    {
+        if (solver == sn.solver)
+            return sn.name;
+    }
+
+    return "?";
+}
+
+StatePath solve(SolverConfig const& config, BoardPtr const& board, StateKey const& inikey)
+{
+    stats::Recorder recorder;
+    StatePath solpath;
+    {
+        ArenaScope arena(config.arena ? ArenaScope::Attached : ArenaScope::Detached);
+        solpath = dispatch(config, board, inikey);
+    }
+    recorder.stop(solpath.stats);
+
+    // The cache holds exact distances only
+    if (config.cache && config.solver != Solver::Greedy)
+        config.cache->insertPath(board->layout(), solpath.keys);
+
+    return solpath;
+}
+
+StatePath tracePath(StateStore const& store, ArenaVector<StateId> const& preds, StateId inistate, StateId final)
+{
+    stats::Reconstruction timer;
+    StatePath solpath;
+
+    for (StateId s = final; s != inistate; s = preds[s])
+        solpath.keys.push_back(store.key(s));
+
+    solpath.keys.push_back(store.key(inistate));
+    std::reverse(solpath.keys.begin(), solpath.keys.end());
+
+    return solpath;
+}
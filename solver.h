@@ -0,0 +1,109 @@
+#pragma once
+
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "state.h"
+#include "statestore.h"
+#include "solutioncache.h"
+#include "patterndb.h"
+#include "pruning.h"
+#include "stats.h"
+
+enum class Solver
+{
+    BFS,
+    AStar,
+    IDAStar,
+    Bidirectional,
+    ParallelBFS,
+    ExternalBFS,
+    Greedy,
+};
+
+Solver solverFromName(std::string const& name);
+char const* solverName(Solver solver);
+
+// Where and how often the breadth first search saves its state, none without a directory
+struct CheckpointConfig
+{
+    std::string dir;
+    double interval = 60;       // seconds between the starts of two writes
+    bool resume = false;        // start from the checkpoint of the puzzle if there is one
+};
+
+struct SolverConfig
+{
+    Solver solver = Solver::BFS;
+    unsigned threads = 0;       // parallel solvers, 0 is one per hardware thread
+
+    // Shared by the tasks of a batch: every solver adds its solution and the bidirectional search
+    // all states its backward half has reached; A* stops at the first cached state
+    std::shared_ptr<SolutionCache> cache{};
+
+    // Pattern databases on top of the road heuristic of A* and IDA*, saved to patternDir if set
+    bool patterns = false;
+    std::string patternDir{};
+
+    // PruneRule bits, used by BFS, A* and IDA*
+    unsigned pruning = 0;
+
+    // Bytes the external BFS keeps in memory, 0 is its default; its layers go to tempDir,
+    // the system temporary directory if empty
+    std::size_t memory = 0;
+    std::string tempDir{};
+
+    // BFS and A* first take the moves of the greedy route as a bound on the solution
+    bool upperBound = true;
+
+    // Breadth first search only
+    CheckpointConfig checkpoint{};
+
+    // State storage from the per thread arena, released at once after the solve; the heap otherwise
+    bool arena = true;
+};
+
+// States of a solution from the initial one to the final one
+struct StatePath
+{
+    BoardPtr board;
+    std::vector<StateKey> keys;
+    std::size_t expanded = 0;   // states whose successors were generated
+    PruneCounts pruned{};       // successors removed, per rule
+    SolveStats stats{};
+};
+
+StatePath solve(SolverConfig const& config, BoardPtr const& board, StateKey const& inikey);
+
+// Bound of the exact solvers when there is no solution known
+constexpr unsigned NO_BOUND = std::numeric_limits<unsigned>::max();
+
+// A state is dropped when its depth plus its heuristic is more than the bound moves
+StatePath solveBfs(BoardPtr const& board, StateKey const& inikey, unsigned pruning = 0, unsigned bound = NO_BOUND,
+                   CheckpointConfig const& checkpoint = {});
+StatePath solveAStar(BoardPtr const& board, StateKey const& inikey, SolutionCache* cache = nullptr, PatternDatabase const* patterns = nullptr,
+                     unsigned pruning = 0, unsigned bound = NO_BOUND);
+StatePath solveIdaStar(BoardPtr const& board, StateKey const& inikey, PatternDatabase const* patterns = nullptr, unsigned pruning = 0);
+StatePath solveBidirectional(BoardPtr const& board, StateKey const& inikey, SolutionCache* cache = nullptr);
+StatePath solveParallelBfs(BoardPtr const& board, StateKey const& inikey, unsigned threads);
+StatePath solveExternalBfs(BoardPtr const& board, StateKey const& inikey, std::size_t memory, std::string const& tempdir);
+
+// Quick route through the nearest pickups and drop-offs, not always the shortest
+StatePath solveGreedy(BoardPtr const& board, StateKey const& inikey);
+
+// Called with every solution as soon as it is found, returns false to stop the search
+using SolutionSink = std::function<bool(StatePath&&)>;
+
+// Count of streamSolutions() that asks for every shortest solution and nothing longer
+constexpr std::size_t ALL_OPTIMAL = 0;
+
+// Distinct solutions in order of length, the first count of them or all the optimal ones.
+// A solution never goes through a state twice and ends at the first final state.
+// Returns how many went to the sink.
+std::size_t streamSolutions(BoardPtr const& board, StateKey const& inikey, std::size_t count, SolutionSink const& sink);
+
+// Walks the predecessors back from the final state to the initial one
+StatePath tracePath(StateStore const& store, ArenaVector<StateId> const& preds, StateId inistate, StateId final);
@@ -2,98 +2,107 @@
 
 #include <boost/container_hash/hash.hpp>
 
-StatePtr State::addState(StateRegistryPtr statereg, StreetsPtr streets, StateKey&& key)
+PreviousStates State::previous() const
 {
-    auto found = statereg->find(key);
+    auto const& codec = m_board->codec();
+    auto const numpets = codec.numPets();
+    Cell const car = codec.car(key());
 
-    if (found != statereg->end())
-        return found->second;
+    std::size_t idropped = numpets;     // home where the car is, may have been carried here
+    std::size_t icapt = numpets;        // captured where it started, may have been picked up here
+    int num_captured = 0;
 
-    StatePtr newstate(new State(statereg, streets, std::move(key)));
-    statereg->insert({ newstate->key(), newstate });
-
-    return newstate;
-}
-
-auto State::adjacent() -> AdjContainerPtr&
-{
-    if (!m_adjacent)
+    for (std::size_t i = 0; i < numpets; ++i)
     {
-        Position const incs[] =
+        PetPos const pet = codec.pet(key(), i);
+
+        if (pet.captured)
         {
-            { 0, 1 }, { 1, 0 }, { 0, -1 }, { -1, 0 },
-        };
+            ++num_captured;
 
-        m_adjacent.reset(new AdjContainer());
+            if (m_board->start(i) == car)
+                icapt = i;
+        }
+        else if (pet.animal == car && pet.isHome(m_board->house(i)))
+            idropped = i;
+    }
 
-        for (auto const& inc : incs)
-        {
-            Car newcar = std::get<1>(key());
+    PreviousStates previous;
 
-            newcar.first += inc.first;
-            newcar.second += inc.second;
+    for (Cell const prevcar : m_board->roads().neighbors(car))
+    {
+        StateKey prevkey = key();
+        codec.setCar(prevkey, prevcar);
 
-            if (!isValidCarPosition(newcar))
-                continue;
+        for (std::size_t i = 0; i < numpets; ++i)
+        {
+            if (codec.pet(prevkey, i).captured)
+                codec.setPet(prevkey, i, { prevcar, true });
+        }
 
-            newcar.first += inc.first;
-            newcar.second += inc.second;
+        for (int dropped = 0; dropped <= (idropped != numpets ? 1 : 0); ++dropped)
+        {
+            StateKey droppedkey = prevkey;
 
-            Pets pets = std::get<0>(key());
-            int num_captured = 0;
-            auto itcapt = pets.end();
-            for (auto it = pets.begin(), endit = pets.end(); it != endit; ++it) {
-                num_captured += it->isCaptured() ? 1 : 0;
-                it->followCar(newcar, false);
+            if (dropped)
+                codec.setPet(droppedkey, idropped, { prevcar, true });
 
-                //check if car meets an animal
-                if (!it->isHome() && !it->isCaptured() && newcar == it->animalPosition())
-                    itcapt = it;
-            }
+            int const prev_captured = num_captured + dropped;
 
-            m_adjacent->push_back({ shared_from_this(), addState(m_statereg, m_streets, { pets, newcar }) });
+            if (prev_captured <= m_board->capacity())
+                previous.push_back(droppedkey);
 
-            if (num_captured < MAX_CAPTURED && itcapt != pets.end())
+            // The capture move is only there when the car had room for one more
+            if (icapt != numpets && prev_captured - 1 < m_board->capacity())
             {
-                itcapt->followCar(newcar, true);
-                m_adjacent->push_back({ shared_from_this(), addState(m_statereg, m_streets, { pets, newcar }) });
+                codec.setPet(droppedkey, icapt, { car, false });
+                previous.push_back(droppedkey);
             }
         }
     }
 
-    return m_adjacent;
+    stats::generated(previous.size());
+
+    return previous;
 }
 
 std::ostream& operator<<(std::ostream& os, State const& s)
 {
-    auto streets = s.m_streets;
+    auto const& board = *s.m_board;
+    auto const& streets = board.streets();
+    auto const& pets = board.pets();
+    auto const& codec = board.codec();
+
+    Position const car = board.positionOf(codec.car(s.key()));
 
-    auto const& pets = std::get<0>(s.key());
-    auto const& car = std::get<1>(s.key());
+    std::vector<Position> animals;
+    animals.reserve(pets.size());
+    for (std::size_t i = 0; i < pets.size(); ++i)
+        animals.push_back(board.positionOf(codec.pet(s.key(), i).animal));
 
-    for (int row = 0, rowcount = static_cast<int>(streets->size()); row < rowcount; ++row)
+    for (int row = 0, rowcount = streets.height(); row < rowcount; ++row)
     {
-        auto const& line = streets->at(static_cast<std::size_t>(row));
+        char const* const line = streets.row(row);
 
-        for (int col = 0, colcount = static_cast<int>(line.size()); col < colcount; ++col)
+        for (int col = 0, colcount = streets.width(); col < colcount; ++col)
         {
-            auto item = line[static_cast<std::size_t>(col)];
+            auto item = line[col];
             Position const pos(row, col);
 
-            if (Position(row, col) == car)
+            if (pos == car)
                 os << CAR;
             else
             {
-                auto found = std::find_if(pets.begin(), pets.end(), [pos](auto const& pet) {
-                    return pos == pet.housePosition() || pos == pet.animalPosition();
-                });
+                std::size_t found = 0;
+                while (found < pets.size() && pos != pets[found].housePosition() && pos != animals[found])
+                    ++found;
 
-                if (found == pets.end())
+                if (found == pets.size())
                     os << item;
-                else if (found->housePosition() == pos)
-                    os << found->houseName();
+                else if (pets[found].housePosition() == pos)
+                    os << pets[found].houseName();
                 else
-                    os << found->animalName();
+                    os << pets[found].animalName();
             }
         }
 
@@ -101,10 +110,10 @@ std::ostream& operator<<(std::ostream& os, State const& s)
     }
 
     os << "Captured: ";
-    for (auto const& pet : pets)
+    for (std::size_t i = 0; i < pets.size(); ++i)
     {
-        if (pet.isCaptured())
-            os << pet.animalName() << ' ';
+        if (codec.pet(s.key(), i).captured)
+            os << pets[i].animalName() << ' ';
     }
 
     os << std::endl;
@@ -114,8 +123,7 @@ std::ostream& operator<<(std::ostream& os, State const& s)
 
 std::size_t hash_value(State const& s)
 {
-    boost::hash<StateKey> hasher;
-    return hasher(s.key());
+    return hash_value(s.key());
 }
 
 #ifdef TEST
@@ -126,6 +134,8 @@ std::size_t hash_value(State const& s)
 
 #include <iostream>
 
+#include "statestore.h"
+
 
 int main()
 {
@@ -135,12 +145,12 @@ int main()
 //    { '+',' ',' ',' ','+',' ','+',' ','+' },
 //    { 'b','+','E','+','A','+','B','+','C' },
 
-    StreetsPtr streets = std::make_shared<Streets>(Streets{
-        { '*','+','*','+','*','+','*','+','*' },
-        { '+',' ','+',' ',' ',' ',' ',' ','+' },
-        { '*','+','*','+','*',' ','*','+','*' },
-        { '+',' ',' ',' ','+',' ','+',' ','+' },
-        { '*','+','*','+','*','+','*','+','*' },
+    Streets streets(5, 9, {
+        '*','+','*','+','*','+','*','+','*',
+        '+',' ','+',' ',' ',' ',' ',' ','+',
+        '*','+','*','+','*',' ','*','+','*',
+        '+',' ',' ',' ','+',' ','+',' ','+',
+        '*','+','*','+','*','+','*','+','*',
     });
 
     constexpr int NUMPETS = 6;
@@ -177,27 +187,24 @@ int main()
         assert(pet.houseName() == 'A' + static_cast<char>(i));
         assert(pet.animalPosition() == animalpos[i]);
         assert(pet.housePosition() == housepos[i]);
-        assert(!pet.isCaptured());
-        assert(!pet.isHome());
     }
 
-    StateRegistryPtr statereg = std::make_shared<StateRegistry>();
+    BoardPtr board = std::make_shared<Board>(std::move(streets), std::move(pets));
+    auto const& codec = board->codec();
+    StateKey key = board->initialKey(car);
 
-//    auto state = State::addState(statereg, streets, { pets, {0,0} });
-//    auto& adj = state->adjacent();
-//    for(auto it = adj->begin(); it != adj->end(); ++it)
-//    {
-//        std::cout << *(it->second) << std::endl;
-//    }
+    assert(codec.car(key) == board->cellOf(car));
+
+    for (std::size_t i = 0; i < NUMPETS; ++i)
+    {
+        auto const pet = codec.pet(key, i);
+        assert(board->positionOf(pet.animal) == animalpos[i]);
+        assert(board->positionOf(board->house(i)) == housepos[i]);
+        assert(!pet.captured);
+        assert(!pet.isHome(board->house(i)));
+    }
 
-//    pets[0].followCar(pets[0].animalPosition(), true);
-//    pets[0].followCar(car, false);
-//    auto state = State::addState(statereg, streets, { pets, car });
-//    auto& adj = state->adjacent();
-//    for(auto it = adj->begin(); it != adj->end(); ++it)
-//    {
-//        std::cout << *(it->second) << std::endl;
-//    }
+    StateStore store(board);
 
     //    { 'a','+','*','+','F','+','f','+','D' },
     //    { '+',' ','+',' ',' ',' ',' ',' ','+' },
@@ -211,25 +218,45 @@ int main()
 
     };
 
-    auto state = State::addState(statereg, streets, { pets, car });
+    store.add(key);
 
     for(auto const& step : steps)
     {
-        state->adjacent();
+        for (auto const& next : store.state(store.find(key)).adjacent())
+            store.add(next);
 
         car.first += 2 * step.first;
         car.second += 2 * step.second;
-        std::for_each(pets.begin(), pets.end(), [car](auto& pet){ pet.followCar(car, true); });
 
-        assert(statereg->find({pets, car}) != statereg->end());
+        Cell const carcell = board->cellOf(car);
+        codec.setCar(key, carcell);
+        for (std::size_t i = 0; i < NUMPETS; ++i)
+        {
+            auto pet = codec.pet(key, i);
+            pet.followCar(carcell, board->house(i), true);
+            codec.setPet(key, i, pet);
+        }
+
+        assert(store.find(key) != INVALID_STATE);
 
-        auto n = statereg->size();
-        state = State::addState(statereg, streets, { pets, car });
+        auto n = store.size();
+        store.add(key);
 
-        assert(n = statereg->size());
+        assert(n == store.size());
     }
 
-    assert(std::all_of(pets.begin(), pets.end(), [](auto const& pet){ return pet.isHome(); }));
+    assert(State(*board, key).isFinal());
+
+    // Without pets the car is done before it moves
+    BoardPtr empty = std::make_shared<Board>(Streets(3, 3, {
+        '*','+','*',
+        '+',' ','+',
+        '*','+','*',
+    }), Pets());
+    StateKey const emptykey = empty->initialKey(Car(0, 0));
+
+    assert(State(*empty, emptykey).isFinal());
+    assert(empty->finalKeys().empty());
 
     return 0;
 }
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <boost/graph/graph_traits.hpp>
+#include <boost/container/static_vector.hpp>
+
+#include "statestore.h"
+#include "pruning.h"
+#include "heuristic.h"
+
+// States that can't be on a route of at most limit moves, by their depth plus heuristic,
+// get no out edges. Depths are recorded as states are added, in breadth first order.
+// The heuristic is only worked out where its ceiling could take a state over the limit.
+struct DepthBound
+{
+    Heuristic const& h;
+    unsigned limit;
+    unsigned ceiling;
+    ArenaVector<Distance> depths;
+
+    bool exceeds(StateId id, StateKey const& key) const
+    {
+        unsigned const depth = depths[id];
+
+        // Against what is left of the limit, an INFINITE ceiling must not wrap around
+        if (ceiling != Heuristic::INFINITE && depth <= limit && ceiling <= limit - depth)
+            return false;
+
+        auto const hv = h(key);
+        return hv == Heuristic::INFINITE || depth > limit || hv > limit - depth;
+    }
+
+    // The states added up to numstates are successors of the given one
+    void record(StateId id, std::size_t numstates)
+    {
+        depths.resize(numstates, static_cast<Distance>(depths[id] + 1));
+    }
+};
+
+// Boost.Graph view of a StateStore. Out edges are generated on the fly from the
+// packed key into a scratch buffer, so an edge range stays valid only until the
+// next out_edges() call. breadth_first_visit never needs more than that.
+// With pruning, the grandparent of a successor is taken from the predecessors being recorded.
+// With a bound, the initial state must be the only one added before the search.
+struct StateGraph {
+    using vertex_descriptor = StateId;
+    using edge_descriptor = std::pair<vertex_descriptor, vertex_descriptor>;
+    using directed_category = boost::directed_tag;
+    using edge_parallel_category = boost::disallow_parallel_edge_tag;
+    using traversal_category = boost::incidence_graph_tag;
+    using out_edge_iterator = edge_descriptor const*;
+    using degree_size_type = std::size_t;
+
+    static vertex_descriptor null_vertex()
+    {
+        return INVALID_STATE;
+    }
+
+    explicit StateGraph(StateStore& store, Pruning* pruning = nullptr, ArenaVector<StateId> const* preds = nullptr,
+                        DepthBound* bound = nullptr)
+        : m_store(store)
+        , m_pruning(pruning)
+        , m_preds(preds)
+        , m_bound(bound)
+    {}
+
+    StateStore& store() const { return m_store; }
+
+    std::pair<out_edge_iterator, out_edge_iterator> outEdges(vertex_descriptor v) const
+    {
+        m_edges.clear();
+
+        if (m_bound && m_bound->exceeds(v, m_store.key(v)))
+            return { m_edges.data(), m_edges.data() };
+
+        auto succs = m_store.successors(v, m_hashes);
+
+        if (m_pruning)
+        {
+            StateId const pred = v < m_preds->size() ? (*m_preds)[v] : INVALID_STATE;
+            m_pruning->apply(pred != INVALID_STATE ? &m_store.key(pred) : nullptr, succs, &m_hashes);
+        }
+
+        for (std::size_t i = 0; i < succs.size(); ++i)
+            m_edges.push_back({ v, m_store.add(succs[i], m_hashes[i]) });
+
+        if (m_bound)
+            m_bound->record(v, m_store.size());
+
+        return { m_edges.data(), m_edges.data() + m_edges.size() };
+    }
+
+private:
+    StateStore& m_store;
+    Pruning* m_pruning;
+    ArenaVector<StateId> const* m_preds;
+    DepthBound* m_bound;
+    mutable boost::container::static_vector<edge_descriptor, MAX_SUCCESSORS> m_edges;
+    mutable SuccessorHashes m_hashes;
+};
+
+inline boost::graph_traits<StateGraph>::vertex_descriptor
+source(boost::graph_traits<StateGraph>::edge_descriptor e, StateGraph const& /*g*/)
+{
+    return e.first;
+}
+
+inline boost::graph_traits<StateGraph>::vertex_descriptor
+target(boost::graph_traits<StateGraph>::edge_descriptor e, StateGraph const& /*g*/)
+{
+    return e.second;
+}
+
+inline std::pair<boost::graph_traits<StateGraph>::out_edge_iterator, boost::graph_traits<StateGraph>::out_edge_iterator>
+out_edges(boost::graph_traits<StateGraph>::vertex_descriptor v, StateGraph const& g)
+{
+    return g.outEdges(v);
+}
+
+inline boost::graph_traits<StateGraph>::degree_size_type
+out_degree(boost::graph_traits<StateGraph>::vertex_descriptor v, StateGraph const& g)
+{
+    auto const edges = g.outEdges(v);
+    return static_cast<std::size_t>(edges.second - edges.first);
+}
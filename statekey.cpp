@@ -0,0 +1,48 @@
+#include "statekey.h"
+
+#include <stdexcept>
+
+namespace
+{
+
+unsigned bitsFor(std::size_t numvalues)
+{
+    unsigned bits = 1;
+    while ((std::size_t(1) << bits) < numvalues)
+        ++bits;
+    return bits;
+}
+
+} // namespace
+
+KeyCodec::KeyCodec(std::size_t numcells, std::size_t numpets)
+{
+    unsigned const cellbits = bitsFor(numcells);
+    std::size_t word = 0;
+    std::size_t shift = 0;
+
+    auto place = [&](unsigned bits) {
+        if (shift + bits > StateKey::WORD_BITS)
+        {
+            ++word;
+            shift = 0;
+        }
+
+        if (word >= StateKey::NUM_WORDS)
+            throw std::runtime_error("Too many pets or junctions to pack a state key");
+
+        Field f;
+        f.word = static_cast<std::uint8_t>(word);
+        f.shift = static_cast<std::uint8_t>(shift);
+        f.mask = (StateKey::Word(1) << bits) - 1;
+
+        shift += bits;
+        return f;
+    };
+
+    m_car = place(cellbits);
+
+    m_pets.reserve(numpets);
+    for (std::size_t i = 0; i < numpets; ++i)
+        m_pets.push_back(place(cellbits + 1));
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+
+#include <boost/operators.hpp>
+#include <boost/container_hash/hash.hpp>
+
+#include "definitions.h"
+#include "pet.h"
+
+// Dynamic part of a search state (car cell plus animal cell and captured bit of every pet)
+// bit-packed into two machine words. The layout of the fields is defined by KeyCodec.
+struct StateKey : boost::equality_comparable1<StateKey>
+{
+    using Word = std::uint64_t;
+    static constexpr std::size_t NUM_WORDS = 2;
+    static constexpr std::size_t WORD_BITS = 64;
+
+    std::array<Word, NUM_WORDS> words{};
+
+    friend bool operator==(StateKey const& l, StateKey const& r)
+    {
+        return l.words == r.words;
+    }
+};
+
+// Hash a state is looked up by, see Zobrist
+using StateHash = std::uint64_t;
+
+inline std::size_t hash_value(StateKey const& k)
+{
+    return boost::hash_range(k.words.begin(), k.words.end());
+}
+
+
+class KeyCodec
+{
+public:
+
+    KeyCodec() = default;
+    KeyCodec(std::size_t numcells, std::size_t numpets);
+
+    std::size_t numPets() const { return m_pets.size(); }
+
+    Cell car(StateKey const& key) const
+    {
+        return static_cast<Cell>(get(key, m_car));
+    }
+
+    void setCar(StateKey& key, Cell car) const
+    {
+        set(key, m_car, car);
+    }
+
+    PetPos pet(StateKey const& key, std::size_t i) const
+    {
+        auto v = get(key, m_pets[i]);
+        return { static_cast<Cell>(v >> 1), (v & 1) != 0 };
+    }
+
+    void setPet(StateKey& key, std::size_t i, PetPos const& pet) const
+    {
+        set(key, m_pets[i], (static_cast<StateKey::Word>(pet.animal) << 1) | (pet.captured ? 1 : 0));
+    }
+
+private:
+
+    // Fields never straddle a word boundary, so every access is a single shift and mask
+    struct Field
+    {
+        std::uint8_t word = 0;
+        std::uint8_t shift = 0;
+        StateKey::Word mask = 0;
+    };
+
+    static StateKey::Word get(StateKey const& key, Field const& f)
+    {
+        return (key.words[f.word] >> f.shift) & f.mask;
+    }
+
+    static void set(StateKey& key, Field const& f, StateKey::Word v)
+    {
+        auto& w = key.words[f.word];
+        w = (w & ~(f.mask << f.shift)) | ((v & f.mask) << f.shift);
+    }
+
+private:
+    Field m_car;
+    std::vector<Field> m_pets;
+};
@@ -0,0 +1,163 @@
+#include "stateregistry.h"
+
+#include <algorithm>
+
+#include "stats.h"
+
+namespace
+{
+
+constexpr std::size_t MIN_CAPACITY = 64;
+
+// Reservation is only a hint, don't let a wild estimate take all the memory up front
+constexpr std::size_t MAX_RESERVE = std::size_t(1) << 20;
+
+// Old slots moved to the new table per insertion. Anything above 4/3 finishes
+// the migration before the new table needs to grow again.
+constexpr std::size_t MIGRATE_STEP = 8;
+
+bool overloaded(std::size_t numkeys, std::size_t capacity)
+{
+    return numkeys * 4 > capacity * 3;
+}
+
+} // namespace
+
+StateHash StateRegistry::hashOf(StateKey const& key)
+{
+    auto h = static_cast<std::uint64_t>(hash_value(key));
+
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+
+    return h;
+}
+
+StateId StateRegistry::lookup(Table const& table, StateKey const& key, std::uint32_t hash) const
+{
+    if (table.empty())
+        return INVALID_STATE;
+
+    std::size_t const mask = table.size() - 1;
+
+    for (std::size_t i = hash & mask; ; i = (i + 1) & mask)
+    {
+        auto const& slot = table[i];
+
+        if (slot.id == INVALID_STATE)
+            return INVALID_STATE;
+
+        if (slot.hash == hash && m_keys[slot.id] == key)
+            return slot.id;
+    }
+}
+
+void StateRegistry::place(Table& table, Slot const& slot)
+{
+    std::size_t const mask = table.size() - 1;
+    std::size_t i = slot.hash & mask;
+
+    while (table[i].id != INVALID_STATE)
+        i = (i + 1) & mask;
+
+    table[i] = slot;
+}
+
+StateId StateRegistry::find(StateKey const& key, StateHash fullhash) const
+{
+    auto const hash = static_cast<std::uint32_t>(fullhash);
+    auto id = lookup(m_table, key, hash);
+
+    if (id == INVALID_STATE && !m_old.empty())
+        id = lookup(m_old, key, hash);
+
+    return id;
+}
+
+std::pair<StateId, bool> StateRegistry::insert(StateKey const& key, StateHash fullhash)
+{
+    auto const hash = static_cast<std::uint32_t>(fullhash);
+    auto id = lookup(m_table, key, hash);
+
+    if (id == INVALID_STATE && !m_old.empty())
+        id = lookup(m_old, key, hash);
+
+    if (id != INVALID_STATE)
+    {
+        stats::added(m_keys.size(), false);
+        return { id, false };
+    }
+
+    if (m_table.empty() || overloaded(m_keys.size() + 1, m_table.size()))
+        grow(std::max(MIN_CAPACITY, m_table.size() * 2));
+
+    id = static_cast<StateId>(m_keys.size());
+    m_keys.push_back(key);
+    m_hashes.push_back(fullhash);
+    place(m_table, { id, hash });
+
+    migrate(MIGRATE_STEP);
+
+    stats::added(m_keys.size(), true);
+
+    return { id, true };
+}
+
+void StateRegistry::reserve(std::size_t numstates)
+{
+    numstates = std::min(numstates, MAX_RESERVE);
+
+    m_keys.reserve(numstates);
+    m_hashes.reserve(numstates);
+
+    std::size_t capacity = MIN_CAPACITY;
+    while (overloaded(numstates, capacity))
+        capacity *= 2;
+
+    if (capacity > m_table.size())
+    {
+        grow(capacity);
+        migrate(m_old.size());
+    }
+}
+
+std::size_t StateRegistry::estimateStates(std::size_t numcells, std::size_t numpets)
+{
+    std::size_t estimate = numcells;
+
+    for (std::size_t i = 0; i < numpets && estimate < MAX_RESERVE; ++i)
+        estimate *= 3;
+
+    return estimate;
+}
+
+void StateRegistry::grow(std::size_t capacity)
+{
+    // A previous growth that hasn't finished yet is completed first
+    migrate(m_old.size());
+
+    m_old.swap(m_table);
+    m_table.assign(capacity, Slot{});
+    m_migrated = 0;
+}
+
+void StateRegistry::migrate(std::size_t numslots)
+{
+    if (m_old.empty())
+        return;
+
+    for (auto const end = m_old.size(); numslots > 0 && m_migrated < end; --numslots, ++m_migrated)
+    {
+        auto const& slot = m_old[m_migrated];
+
+        if (slot.id != INVALID_STATE)
+            place(m_table, slot);
+    }
+
+    if (m_migrated == m_old.size())
+    {
+        Table(m_old.get_allocator()).swap(m_old);
+        m_migrated = 0;
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+#include "arena.h"
+#include "statekey.h"
+
+using StateId = std::uint32_t;
+
+constexpr StateId INVALID_STATE = 0xffffffff;
+
+// Set of state keys numbered densely in insertion order.
+// Keys and their hashes live in contiguous arrays indexed by StateId; the hash table is open addressing
+// with linear probing over (id, hash) slots, so a probe only touches a key when the cached hash matches.
+// Callers hand in the hash of every key, which must always be the same for a key in one registry;
+// searches derive it from the parent with Board::adjacent() and never hash a whole key again.
+// When the table fills up it doubles, and the old slots are moved over a few at a time
+// by the following insertions instead of all at once.
+// Keys and slots come from the arena of the solve if there is one.
+class StateRegistry
+{
+public:
+
+    std::size_t size() const { return m_keys.size(); }
+    std::size_t capacity() const { return m_keys.capacity(); }
+    bool empty() const { return m_keys.empty(); }
+
+    StateKey const& key(StateId id) const { return m_keys[id]; }
+    StateHash hash(StateId id) const { return m_hashes[id]; }
+
+    StateId find(StateKey const& key, StateHash hash) const;
+    StateId find(StateKey const& key) const { return find(key, hashOf(key)); }
+
+    // Returns the id of the key and whether it has just been added
+    std::pair<StateId, bool> insert(StateKey const& key, StateHash hash);
+    std::pair<StateId, bool> insert(StateKey const& key) { return insert(key, hashOf(key)); }
+
+    void reserve(std::size_t numstates);
+
+    // Rough number of reachable states: the car may be anywhere, every pet is either
+    // waiting at its start, riding in the car or at home
+    static std::size_t estimateStates(std::size_t numcells, std::size_t numpets);
+
+    // Hash of a key without a board to take a Zobrist hash from.
+    // Slots keep the low bits, the high ones are left for callers that shard keys over several registries.
+    static StateHash hashOf(StateKey const& key);
+
+private:
+
+    struct Slot
+    {
+        StateId id = INVALID_STATE;
+        std::uint32_t hash = 0;
+    };
+
+    using Table = ArenaVector<Slot>;
+
+    StateId lookup(Table const& table, StateKey const& key, std::uint32_t hash) const;
+    static void place(Table& table, Slot const& slot);
+
+    void grow(std::size_t capacity);
+    void migrate(std::size_t numslots);
+
+private:
+    ArenaVector<StateKey> m_keys;
+    ArenaVector<StateHash> m_hashes;
+    Table m_table;
+    Table m_old;            // table being migrated, empty when no growth is in progress
+    std::size_t m_migrated = 0;
+};
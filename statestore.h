@@ -0,0 +1,46 @@
+#pragma once
+
+#include "state.h"
+#include "stateregistry.h"
+
+// All states discovered by one search. States are referred to by their dense StateId,
+// successors are generated from the packed keys on demand and never stored.
+// Keys are hashed by the Zobrist table of the board; successors() hands out the hashes
+// of the successors along with them, so that adding those never hashes a whole key.
+class StateStore
+{
+public:
+
+    explicit StateStore(BoardPtr board);
+
+    Board const& board() const { return *m_board; }
+
+    std::size_t size() const { return m_registry.size(); }
+    std::size_t capacity() const { return m_registry.capacity(); }
+
+    StateKey const& key(StateId id) const { return m_registry.key(id); }
+    State state(StateId id) const { return { *m_board, key(id) }; }
+    bool isFinal(StateId id) const { return state(id).isFinal(); }
+
+    StateHash hash(StateId id) const { return m_registry.hash(id); }
+
+    StateId find(StateKey const& key) const { return m_registry.find(key, m_board->hash(key)); }
+    StateId add(StateKey const& key) { return m_registry.insert(key, m_board->hash(key)).first; }
+    StateId add(StateKey const& key, StateHash hash) { return m_registry.insert(key, hash).first; }
+
+    Successors successors(StateId id, SuccessorHashes& hashes) const
+    {
+        return m_board->adjacent(key(id), hash(id), hashes);
+    }
+
+    void reserve(std::size_t numstates) { m_registry.reserve(numstates); }
+
+private:
+    BoardPtr m_board;
+    StateRegistry m_registry;
+};
+
+inline StateStore::StateStore(BoardPtr board)
+    : m_board(std::move(board))
+{
+}
@@ -0,0 +1,100 @@
+#include "stats.h"
+
+#include <algorithm>
+
+namespace stats
+{
+
+Counters since(Counters const& start)
+{
+    Counters delta;
+    delta.reconstructSeconds = counters.reconstructSeconds - start.reconstructSeconds;
+#if PETDETECTIVE_STATS
+    delta.generated = counters.generated - start.generated;
+    delta.duplicates = counters.duplicates - start.duplicates;
+    delta.peakStates = counters.peakStates;
+    delta.allocated = counters.allocated - start.allocated;
+    delta.checkpoints = counters.checkpoints - start.checkpoints;
+    delta.checkpointBytes = counters.checkpointBytes - start.checkpointBytes;
+    delta.checkpointSeconds = counters.checkpointSeconds - start.checkpointSeconds;
+    delta.checkpointWriteSeconds = counters.checkpointWriteSeconds - start.checkpointWriteSeconds;
+    delta.resumedStates = counters.resumedStates - start.resumedStates;
+#endif
+    return delta;
+}
+
+void add(Counters const& delta)
+{
+    counters.reconstructSeconds += delta.reconstructSeconds;
+#if PETDETECTIVE_STATS
+    counters.generated += delta.generated;
+    counters.duplicates += delta.duplicates;
+    counters.peakStates = std::max(counters.peakStates, delta.peakStates);
+    counters.allocated += delta.allocated;
+    counters.checkpoints += delta.checkpoints;
+    counters.checkpointBytes += delta.checkpointBytes;
+    counters.checkpointSeconds += delta.checkpointSeconds;
+    counters.checkpointWriteSeconds += delta.checkpointWriteSeconds;
+    counters.resumedStates += delta.resumedStates;
+#endif
+}
+
+Recorder::Recorder()
+    : m_saved(counters)
+    , m_start(Clock::now())
+{
+    counters = Counters();
+#if PETDETECTIVE_STATS
+    counters.frontier = &m_frontier;
+#endif
+}
+
+Recorder::~Recorder()
+{
+    if (m_stopped)
+        return;
+
+    SolveStats ignored;
+    stop(ignored);
+}
+
+void Recorder::peek(SolveStats& stats) const
+{
+    double const elapsed = std::chrono::duration<double>(Clock::now() - m_start).count();
+
+    stats.reconstructSeconds = counters.reconstructSeconds;
+    stats.searchSeconds = elapsed - counters.reconstructSeconds;
+#if PETDETECTIVE_STATS
+    stats.generated = counters.generated;
+    stats.duplicates = counters.duplicates;
+    stats.peakStates = counters.peakStates;
+    stats.allocated = counters.allocated;
+    stats.checkpoints = counters.checkpoints;
+    stats.checkpointBytes = counters.checkpointBytes;
+    stats.checkpointSeconds = counters.checkpointSeconds;
+    stats.checkpointWriteSeconds = counters.checkpointWriteSeconds;
+    stats.resumedStates = counters.resumedStates;
+    stats.frontier = m_frontier;
+#endif
+}
+
+void Recorder::stop(SolveStats& stats)
+{
+    peek(stats);
+    stats.frontier = std::move(m_frontier);
+
+    // What was counted here also counts for an outer recorder
+    Counters const inner = counters;
+    counters = m_saved;
+    add(inner);
+
+    m_stopped = true;
+}
+
+void Recorder::discard()
+{
+    counters = m_saved;
+    m_stopped = true;
+}
+
+} // namespace stats
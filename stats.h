@@ -0,0 +1,188 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+// Per state counters are compiled in unless PETDETECTIVE_STATS is 0, only the times are kept then.
+// They are plain thread-local variables, so counting is an add without a branch or a lock.
+#ifndef PETDETECTIVE_STATS
+#define PETDETECTIVE_STATS 1
+#endif
+
+// What happened during one solve
+struct SolveStats
+{
+    std::size_t generated = 0;          // successor keys produced
+    std::size_t duplicates = 0;         // keys added to a state set that already had them
+    std::size_t peakStates = 0;         // largest state set
+    std::size_t allocated = 0;          // bytes of state storage allocated by the solving thread and its workers
+    std::vector<std::size_t> frontier;  // states per depth, breadth first solvers only
+
+    double parseSeconds = 0;
+    double searchSeconds = 0;
+    double reconstructSeconds = 0;      // walking back the path once the goal is found
+
+    std::size_t checkpoints = 0;        // search states written out
+    std::size_t checkpointBytes = 0;
+    double checkpointSeconds = 0;       // the search was held up by checkpoints
+    double checkpointWriteSeconds = 0;  // writing them in the background
+    std::size_t resumedStates = 0;      // states read back from a checkpoint at the start
+};
+
+namespace stats
+{
+
+using Clock = std::chrono::steady_clock;
+
+struct Counters
+{
+    std::size_t generated = 0;
+    std::size_t duplicates = 0;
+    std::size_t peakStates = 0;
+    std::size_t allocated = 0;
+    double reconstructSeconds = 0;
+    std::size_t checkpoints = 0;
+    std::size_t checkpointBytes = 0;
+    double checkpointSeconds = 0;
+    double checkpointWriteSeconds = 0;
+    std::size_t resumedStates = 0;
+    std::vector<std::size_t>* frontier = nullptr;   // set while a solve is recorded
+};
+
+inline thread_local Counters counters;
+
+inline void generated(std::size_t n)
+{
+#if PETDETECTIVE_STATS
+    counters.generated += n;
+#else
+    (void)n;
+#endif
+}
+
+// Size of a state set
+inline void states(std::size_t numstates)
+{
+#if PETDETECTIVE_STATS
+    if (numstates > counters.peakStates)
+        counters.peakStates = numstates;
+#else
+    (void)numstates;
+#endif
+}
+
+// A key was already known
+inline void duplicate()
+{
+#if PETDETECTIVE_STATS
+    ++counters.duplicates;
+#endif
+}
+
+// A key has been added to a state set of that size now
+inline void added(std::size_t numstates, bool inserted)
+{
+#if PETDETECTIVE_STATS
+    counters.duplicates += inserted ? 0 : 1;
+    states(numstates);
+#else
+    (void)numstates;
+    (void)inserted;
+#endif
+}
+
+// Storage for states was taken from an arena or the heap
+inline void allocated(std::size_t bytes)
+{
+#if PETDETECTIVE_STATS
+    counters.allocated += bytes;
+#else
+    (void)bytes;
+#endif
+}
+
+// Number of states about to be expanded at the next depth
+inline void frontier(std::size_t numstates)
+{
+#if PETDETECTIVE_STATS
+    if (counters.frontier)
+        counters.frontier->push_back(numstates);
+#else
+    (void)numstates;
+#endif
+}
+
+// A checkpoint of that size has been written, holding up the search for stallSeconds.
+// No bytes for one that was given up or failed, only its time counts then.
+inline void checkpoint(std::size_t bytes, double stallSeconds, double writeSeconds)
+{
+#if PETDETECTIVE_STATS
+    counters.checkpoints += bytes ? 1 : 0;
+    counters.checkpointBytes += bytes;
+    counters.checkpointSeconds += stallSeconds;
+    counters.checkpointWriteSeconds += writeSeconds;
+#else
+    (void)bytes;
+    (void)stallSeconds;
+    (void)writeSeconds;
+#endif
+}
+
+// The search starts over from that many states read back
+inline void resumed(std::size_t numstates)
+{
+#if PETDETECTIVE_STATS
+    counters.resumedStates += numstates;
+#else
+    (void)numstates;
+#endif
+}
+
+// Counts of the thread since start, for workers to hand over to the thread that runs the solve
+Counters since(Counters const& start);
+void add(Counters const& delta);
+
+// Times the path reconstruction of a solver
+class Reconstruction
+{
+public:
+
+    Reconstruction() : m_start(Clock::now()) {}
+
+    ~Reconstruction()
+    {
+        counters.reconstructSeconds += std::chrono::duration<double>(Clock::now() - m_start).count();
+    }
+
+private:
+    Clock::time_point m_start;
+};
+
+// Gathers the counters of the calling thread from construction to stop()
+class Recorder
+{
+public:
+
+    Recorder();
+    ~Recorder();
+
+    Recorder(Recorder const&) = delete;
+    Recorder& operator=(Recorder const&) = delete;
+
+    void stop(SolveStats& stats);
+
+    // Stops without counting anything for an outer recorder
+    void discard();
+
+    // The stats so far, the recording goes on
+    void peek(SolveStats& stats) const;
+
+private:
+    Counters m_saved;
+    std::vector<std::size_t> m_frontier;
+    Clock::time_point m_start;
+    bool m_stopped = false;
+};
+
+} // namespace stats
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "definitions.h"
+
+// Street map, one char per position (ROAD, WAY or NOWAY) stored row after row
+class Streets
+{
+public:
+
+    Streets() = default;
+
+    Streets(int height, int width, std::vector<char>&& cells)
+        : m_height(height)
+        , m_width(width)
+        , m_cells(std::move(cells))
+    {
+    }
+
+    int height() const { return m_height; }
+    int width() const { return m_width; }
+    bool empty() const { return m_cells.empty(); }
+
+    bool contains(Position const& pos) const
+    {
+        return pos.first >= 0 && pos.second >= 0 && pos.first < m_height && pos.second < m_width;
+    }
+
+    char at(int row, int col) const { return m_cells[static_cast<std::size_t>(row * m_width + col)]; }
+    char at(Position const& pos) const { return at(pos.first, pos.second); }
+
+    // The width() chars of a row
+    char const* row(int row) const { return m_cells.data() + static_cast<std::size_t>(row * m_width); }
+
+private:
+    int m_height = 0;
+    int m_width = 0;
+    std::vector<char> m_cells;
+};
+
+using StreetsPtr = std::shared_ptr<Streets>;
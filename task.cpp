@@ -0,0 +1,65 @@
+#include "task.h"
+
+#include <fstream>
+#include <iterator>
+
+#include "puzzle.h"
+
+Task::Task(std::string const& filename)
+{
+    std::ifstream ifs(filename, std::ios::binary);
+
+    if (!ifs)
+        throw std::runtime_error("Can't open file " + filename);
+
+    std::string const text{ std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>() };
+
+    parse(text);
+}
+
+Task::Task(std::string_view text)
+{
+    parse(text);
+}
+
+void Task::parse(std::string_view text)
+{
+    auto const start = stats::Clock::now();
+
+    Puzzle puzzle = parsePuzzle(text);
+
+    m_car = puzzle.car;
+    m_board = std::make_shared<Board>(std::move(puzzle.streets), std::move(puzzle.pets));
+    m_inikey = m_board->initialKey(m_car);
+
+    m_parseSeconds = std::chrono::duration<double>(stats::Clock::now() - start).count();
+}
+
+StatePath Task::Solve(SolverConfig const& config) const
+{
+    auto solpath = solve(config, m_board, m_inikey);
+    solpath.stats.parseSeconds = m_parseSeconds;
+    return solpath;
+}
+
+std::size_t Task::Stream(std::size_t count, SolutionSink const& sink, SolveStats* stats) const
+{
+    stats::Recorder recorder;
+    std::size_t found = 0;
+    {
+        ArenaScope arena;
+        found = streamSolutions(m_board, m_inikey, count, [this, &recorder, &sink](StatePath&& path) {
+            recorder.peek(path.stats);
+            path.stats.parseSeconds = m_parseSeconds;
+            return sink(std::move(path));
+        });
+    }
+
+    if (stats)
+    {
+        recorder.stop(*stats);
+        stats->parseSeconds = m_parseSeconds;
+    }
+
+    return found;
+}
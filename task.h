@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <string_view>
+
+#include "state.h"
+#include "solver.h"
+
+class Task
+{
+public:
+
+    explicit Task(std::string const& filename);
+
+    // Parses the text of one puzzle, which only has to stay valid during the call
+    explicit Task(std::string_view text);
+
+    StatePath Solve(SolverConfig const& config = {}) const;
+
+    // See streamSolutions(). Every solution comes with the statistics of the run up to it,
+    // those of the whole run go to stats if asked for.
+    std::size_t Stream(std::size_t count, SolutionSink const& sink, SolveStats* stats = nullptr) const;
+
+    BoardPtr const& board() const { return m_board; }
+    StateKey const& initialKey() const { return m_inikey; }
+
+    // Rough cost of solving, for scheduling: the number of pets dominates, then the number of junctions
+    std::size_t difficulty() const { return (m_board->pets().size() << 16) | m_board->numCells(); }
+
+private:
+
+    void parse(std::string_view text);
+
+private:
+    BoardPtr m_board;
+    Position m_car = INVALID_POSITION;
+    StateKey m_inikey;
+    double m_parseSeconds = 0;
+};
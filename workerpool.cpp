@@ -0,0 +1,121 @@
+#include "workerpool.h"
+
+#include <algorithm>
+
+#include "arena.h"
+
+WorkerPool::WorkerPool(unsigned threads)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    m_queues.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i)
+        m_queues.push_back(std::make_unique<Queue>());
+
+    m_threads.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i)
+        m_threads.emplace_back([this, i]() { run(i); });
+}
+
+WorkerPool::~WorkerPool()
+{
+    wait();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_wakeup.notify_all();
+
+    for (auto& t : m_threads)
+        t.join();
+}
+
+void WorkerPool::submit(Job job, std::size_t priority)
+{
+    auto& queue = *m_queues[m_next++ % m_queues.size()];
+
+    // Counted before a worker can see the job, so the worker's decrements never come first
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::lock_guard<std::mutex> queuelock(queue.mutex);
+
+        auto const pos = std::find_if(queue.jobs.begin(), queue.jobs.end(), [priority](auto const& queued) {
+            return queued.first < priority;
+        });
+
+        queue.jobs.insert(pos, { priority, std::move(job) });
+        ++m_queued;
+        ++m_unfinished;
+    }
+
+    m_wakeup.notify_one();
+}
+
+void WorkerPool::wait(std::size_t maxunfinished)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this, maxunfinished]() { return m_unfinished <= maxunfinished; });
+}
+
+bool WorkerPool::pop(unsigned self, Job& job)
+{
+    auto const numqueues = static_cast<unsigned>(m_queues.size());
+    bool found = false;
+
+    for (unsigned i = 0; i < numqueues && !found; ++i)
+    {
+        auto& queue = *m_queues[(self + i) % numqueues];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (queue.jobs.empty())
+            continue;
+
+        // Stolen jobs too are the most important ones, so big puzzles start first wherever they were dealt
+        job = std::move(queue.jobs.front().second);
+        queue.jobs.pop_front();
+
+        found = true;
+    }
+
+    if (found)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        --m_queued;
+    }
+
+    return found;
+}
+
+void WorkerPool::run(unsigned self)
+{
+    for (;;)
+    {
+        Job job;
+
+        if (pop(self, job))
+        {
+            job();
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                --m_unfinished;
+            }
+
+            m_idle.notify_all();
+
+            continue;
+        }
+
+        // Nothing to solve for now, the memory kept for the next solve is better off with the heap
+        Arena::local().release();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wakeup.wait(lock, [this]() { return m_stop || m_queued > 0; });
+
+        if (m_stop && m_queued == 0)
+            return;
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads, each with its own job queue. Jobs are dealt round robin
+// and kept in priority order within a queue; an idle worker takes the first job of its
+// own queue and, when that is empty, steals the first job of another one.
+class WorkerPool
+{
+public:
+
+    using Job = std::function<void()>;
+
+    // 0 threads is one per hardware thread
+    explicit WorkerPool(unsigned threads = 0);
+    ~WorkerPool();
+
+    WorkerPool(WorkerPool const&) = delete;
+    WorkerPool& operator=(WorkerPool const&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(m_threads.size()); }
+
+    // Jobs with a higher priority start earlier
+    void submit(Job job, std::size_t priority = 0);
+
+    // Blocks until no more than the given number of submitted jobs are left unfinished
+    void wait(std::size_t maxunfinished = 0);
+
+private:
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<std::pair<std::size_t, Job>> jobs;
+    };
+
+    bool pop(unsigned self, Job& job);
+    void run(unsigned self);
+
+private:
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_threads;
+    std::atomic<unsigned> m_next{ 0 };
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::condition_variable m_idle;
+    std::size_t m_queued = 0;       // jobs in the queues
+    std::size_t m_unfinished = 0;   // jobs submitted and not finished yet
+    bool m_stop = false;
+};
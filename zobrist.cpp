@@ -0,0 +1,58 @@
+#include "zobrist.h"
+
+#include <random>
+
+#include "board.h"
+
+namespace
+{
+
+// Fixed, so a key hashes the same in every run
+constexpr std::uint64_t SEED = 0x5eed0f9e7de7ec71ULL;
+
+} // namespace
+
+Zobrist::Zobrist(Board const& board)
+    : m_numcells(board.numCells())
+    , m_drop(m_numcells, 0)
+    , m_pick(m_numcells, 0)
+{
+    auto const numpets = board.pets().size();
+    std::mt19937_64 rng(SEED);
+
+    m_car.resize(m_numcells);
+    for (auto& h : m_car)
+        h = rng();
+
+    m_waiting.resize(numpets * m_numcells);
+    for (auto& h : m_waiting)
+        h = rng();
+
+    m_captured.resize(numpets);
+    for (auto& h : m_captured)
+        h = rng();
+
+    for (std::size_t i = 0; i < numpets; ++i)
+    {
+        Cell const house = board.house(i);
+        Cell const start = board.start(i);
+
+        m_drop[house] = m_captured[i] ^ m_waiting[i * m_numcells + house];
+
+        if (start != house)
+            m_pick[start] = m_waiting[i * m_numcells + start] ^ m_captured[i];
+    }
+}
+
+StateHash Zobrist::operator()(KeyCodec const& codec, StateKey const& key) const
+{
+    StateHash hash = m_car[codec.car(key)];
+
+    for (std::size_t i = 0, numpets = codec.numPets(); i < numpets; ++i)
+    {
+        PetPos const pet = codec.pet(key, i);
+        hash ^= pet.captured ? m_captured[i] : m_waiting[i * m_numcells + pet.animal];
+    }
+
+    return hash;
+}
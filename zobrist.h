@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+
+#include "statekey.h"
+
+class Board;
+
+// Zobrist hashing of keys: a random word per car cell and per pet, cell and captured flag,
+// all XOR-ed together. A captured pet is always where the car is, so its word is the same
+// for every cell. A move then changes the word of the car and of the pet picked up or dropped
+// off if any, and the hash of a successor is that of its parent with those words XOR-ed in.
+class Zobrist
+{
+public:
+
+    Zobrist() = default;
+    explicit Zobrist(Board const& board);
+
+    // Hash of a key from scratch
+    StateHash operator()(KeyCodec const& codec, StateKey const& key) const;
+
+    StateHash car(Cell cell) const { return m_car[cell]; }
+
+    // Change when the pet whose house the cell is gets dropped off there
+    StateHash dropAt(Cell cell) const { return m_drop[cell]; }
+
+    // Change when the pet waiting at the cell gets picked up
+    StateHash pickAt(Cell cell) const { return m_pick[cell]; }
+
+private:
+    std::size_t m_numcells = 0;
+    std::vector<StateHash> m_car;
+    std::vector<StateHash> m_waiting;   // per pet and cell
+    std::vector<StateHash> m_captured;  // per pet
+    std::vector<StateHash> m_drop;
+    std::vector<StateHash> m_pick;
+};